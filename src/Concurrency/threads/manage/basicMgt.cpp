@@ -4,6 +4,7 @@
 #include <iostream>
 #include <memory>
 #include <numeric>
+#include <parallel_algorithms.hpp>
 #include <ranges>
 #include <ratio>
 #include <thread>
@@ -11,6 +12,7 @@
 #include <vector>
 
 using std::cout, std::endl, std::thread;
+using mts::concurrency::ThreadPool, mts::concurrency::parallel_reduce;
 using std::string;
 using std::vector;
 namespace rg = std::ranges;
@@ -144,37 +146,10 @@ unsigned long long factorial(unsigned long long n) {
 
 // Parallel version of std::accumulate
 template <typename Iterator, typename T>
-struct AccumulateBlock {
-    void operator()(Iterator beg, Iterator end, T& result) { result = std::accumulate(beg, end, result); }
-};
-
-template <typename Iterator, typename T>
-T parallelAccumulate(Iterator beg, Iterator end, T init) {
-    size_t len = std::distance(beg, end);
-
-    if (!len) return init;
-
-    const size_t minPerThread{25};
-    const size_t maxThreads{(len + minPerThread - 1) / minPerThread};
-    const size_t hardwareThreads{thread::hardware_concurrency()};
-    const size_t numThreads{std::min(hardwareThreads == 0 ? 2 : hardwareThreads, maxThreads)};
-
-    const size_t blockSize{len / numThreads};
-    vector<T> results(numThreads);
-    vector<thread> threads(numThreads - 1);
-    Iterator blockStart{beg};
-
-    for (size_t i{}; i < numThreads - 1; i++) {
-        Iterator blockEnd{blockStart};
-        std::advance(blockEnd, blockSize);
-        threads.at(i) = thread(AccumulateBlock<Iterator, T>(), blockStart, blockEnd, std::ref(results.at(i)));
-        blockStart = blockEnd;
-    }
-
-    AccumulateBlock<Iterator, T>()(blockStart, end, results[numThreads - 1]);
-    for (auto& t : threads) t.join();
-
-    return std::accumulate(results.begin(), results.end(), init);
+T parallelAccumulate(Iterator beg, Iterator end, T init, ThreadPool& pool = ThreadPool::global()) {
+    // Blocks run on the shared pool instead of spawning a thread per block on every call
+    const size_t minPerBlock{25};
+    return parallel_reduce(pool, beg, end, init, std::plus<>{}, minPerBlock);
 }
 
 int main() {
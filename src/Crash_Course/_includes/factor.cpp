@@ -0,0 +1,178 @@
+#include "factor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+namespace {
+    using Factor::u64, Factor::mulMod;
+
+    // Mod 30 wheel, skips every multiple of 2, 3 and 5 starting from 7
+    constexpr std::array<u64, 8> WHEEL_STEPS{4, 2, 4, 2, 4, 6, 2, 6};
+    // Trial division only takes out the small factors, rho handles the rest
+    constexpr u64 TRIAL_LIMIT{1 << 10};
+
+    using u128 = unsigned __int128;
+
+    // Montgomery arithmetic mod an odd n, values are kept as x * 2^64 mod n which turns every modular
+    // multiplication into two plain multiplications instead of a 128-bit division
+    struct Montgomery {
+        explicit Montgomery(u64 n) : n{n}, nInv{inverse(n)}, r2{mulMod(-n % n, -n % n, n)} {}
+
+        // n * nInv == 1 mod 2^64, Newton's iteration doubles the correct bits every step
+        static u64 inverse(u64 n) {
+            u64 x{n};
+            for (int i{}; i < 5; i++) x *= 2 - n * x;
+            return x;
+        }
+
+        [[nodiscard]] u64 reduce(u128 t) const {
+            const u64 m = static_cast<u64>(t) * nInv;
+            const auto tHi = static_cast<u64>(t >> 64);
+            const auto mnHi = static_cast<u64>((static_cast<u128>(m) * n) >> 64);
+            return tHi < mnHi ? tHi - mnHi + n : tHi - mnHi;
+        }
+
+        [[nodiscard]] u64 mul(u64 a, u64 b) const { return reduce(static_cast<u128>(a) * b); }
+        [[nodiscard]] u64 add(u64 a, u64 b) const {
+            const auto res = a + b;
+            return (res < a || res >= n) ? res - n : res;
+        }
+        [[nodiscard]] u64 to(u64 a) const { return mul(a % n, r2); }
+
+        [[nodiscard]] u64 pow(u64 base, u64 exp) const {
+            auto res = to(1);
+            while (exp) {
+                if (exp & 1) res = mul(res, base);
+                base = mul(base, base);
+                exp >>= 1;
+            }
+            return res;
+        }
+
+        const u64 n;
+        const u64 nInv;
+        const u64 r2;
+    };
+
+    bool millerRabinWitness(const Montgomery& mont, u64 d, int s, u64 a) {
+        const auto one = mont.to(1);
+        const auto minusOne = mont.n - one;
+        auto x = mont.pow(mont.to(a), d);
+        if (x == one || x == minusOne) return false;
+        for (int r{1}; r < s; r++) {
+            x = mont.mul(x, x);
+            if (x == minusOne) return false;
+        }
+        return true;
+    }
+
+    // splitmix64, good enough to pick rho's polynomial and starting point
+    u64 nextRandom(u64& state) {
+        auto z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Divides out every prime below TRIAL_LIMIT, returns what is left
+    u64 trialDivide(u64 n, std::vector<u64>& factors) {
+        for (u64 p : {2, 3, 5}) {
+            while (n % p == 0) {
+                factors.push_back(p);
+                n /= p;
+            }
+        }
+
+        size_t step{};
+        for (u64 d{7}; d < TRIAL_LIMIT && d * d <= n; d += WHEEL_STEPS[step++ & 7]) {
+            while (n % d == 0) {
+                factors.push_back(d);
+                n /= d;
+            }
+        }
+        return n;
+    }
+
+    void factorLarge(u64 n, std::vector<u64>& factors) {
+        if (n == 1) return;
+        if (Factor::isPrime(n)) {
+            factors.push_back(n);
+            return;
+        }
+        const auto d = Factor::pollardRho(n);
+        factorLarge(d, factors);
+        factorLarge(n / d, factors);
+    }
+}  // namespace
+
+bool Factor::isPrime(u64 n) {
+    if (n < 2) return false;
+    constexpr std::array<u64, 12> bases{2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    for (auto p : bases) {
+        if (n % p == 0) return n == p;
+    }
+
+    auto d = n - 1;
+    int s{};
+    while ((d & 1) == 0) {
+        d >>= 1;
+        s++;
+    }
+
+    const Montgomery mont{n};
+    return std::none_of(bases.begin(), bases.end(), [&](u64 a) { return millerRabinWitness(mont, d, s, a); });
+}
+
+u64 Factor::pollardRho(u64 n) {
+    if (n % 2 == 0) return 2;
+
+    // Products of |x - y| are batched so only one gcd is taken every M steps
+    // Everything stays in Montgomery form, gcd(q * 2^64, n) == gcd(q, n) since n is odd
+    constexpr u64 M{128};
+    const Montgomery mont{n};
+    u64 state{n};
+
+    while (true) {
+        const auto c = nextRandom(state) % (n - 1) + 1;
+        auto f = [&](u64 x) { return mont.add(mont.mul(x, x), c); };
+
+        u64 y = nextRandom(state) % n;
+        u64 x{}, ys{}, q{mont.to(1)}, g{1};
+
+        for (u64 r{1}; g == 1; r *= 2) {
+            x = y;
+            for (u64 i{}; i < r; i++) y = f(y);
+
+            for (u64 k{}; k < r && g == 1; k += M) {
+                ys = y;
+                for (u64 i{}; i < std::min(M, r - k); i++) {
+                    y = f(y);
+                    q = mont.mul(q, x > y ? x - y : y - x);
+                }
+                g = std::gcd(q, n);
+            }
+        }
+
+        // The batch overshot, step back through it one gcd at a time
+        if (g == n) {
+            do {
+                ys = f(ys);
+                g = std::gcd(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+
+        if (g != n) return g;
+        // Cycle closed without a factor, retry with a different polynomial
+    }
+}
+
+std::vector<Factor::u64> Factor::primeFactors(u64 n) {
+    std::vector<u64> factors;
+    if (n < 2) return factors;
+
+    n = trialDivide(n, factors);
+    factorLarge(n, factors);
+    std::sort(factors.begin(), factors.end());
+    return factors;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// 64-bit primality testing and integer factorization
+namespace Factor {
+    using u64 = std::uint64_t;
+
+    // (a * b) mod m without overflow
+    constexpr u64 mulMod(u64 a, u64 b, u64 m) {
+        return static_cast<u64>(static_cast<unsigned __int128>(a) * b % m);
+    }
+
+    // (base ^ exp) mod m by square and multiply
+    constexpr u64 powMod(u64 base, u64 exp, u64 m) {
+        u64 res{1};
+        base %= m;
+        while (exp) {
+            if (exp & 1) res = mulMod(res, base, m);
+            base = mulMod(base, base, m);
+            exp >>= 1;
+        }
+        return res;
+    }
+
+    // Deterministic Miller-Rabin, the first 12 prime bases are enough for every n < 2^64
+    bool isPrime(u64 n);
+
+    // Returns a non trivial factor of a composite n using Brent's variant of Pollard's rho
+    u64 pollardRho(u64 n);
+
+    // Prime factors of n in ascending order, repeated according to multiplicity
+    std::vector<u64> primeFactors(u64 n);
+}  // namespace Factor
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+// Parallel versions of the common <algorithm>/<numeric> building blocks running on a ThreadPool
+// Ranges are split into blocks of at least grain elements, blocks are what gets scheduled on the pool
+namespace mts::concurrency {
+
+    inline constexpr size_t DEFAULT_GRAIN{1 << 12};
+
+    // Keeps per block partial results on their own cache line so neighbouring workers don't false share
+    template <typename T>
+    struct alignas(64) Padded {
+        T value{};
+    };
+
+    namespace detail {
+        // At most a few blocks per worker, enough to balance without making the serial combine step expensive
+        inline size_t blockCount(const ThreadPool& pool, size_t len, size_t grain) {
+            grain = std::max<size_t>(grain, 1);
+            const size_t maxBlocks{(pool.size() + 1) * 4};
+            return std::max<size_t>(1, std::min((len + grain - 1) / grain, maxBlocks));
+        }
+
+        inline std::pair<size_t, size_t> blockBounds(size_t block, size_t numBlocks, size_t len) {
+            return {block * len / numBlocks, (block + 1) * len / numBlocks};
+        }
+    }  // namespace detail
+
+    // op must be associative, blocks are combined left to right so it does not need to be commutative
+    template <std::random_access_iterator Itr, typename T, typename BinaryOp = std::plus<>>
+    T parallel_reduce(ThreadPool& pool, Itr first, Itr last, T init, BinaryOp op = {}, size_t grain = DEFAULT_GRAIN) {
+        const auto len = static_cast<size_t>(std::distance(first, last));
+        if (len == 0) return init;
+
+        const auto numBlocks = detail::blockCount(pool, len, grain);
+        if (numBlocks == 1) return std::accumulate(first, last, std::move(init), op);
+
+        std::vector<Padded<T>> partials(numBlocks);
+        parallel_for(pool, size_t{0}, numBlocks, [&](size_t block) {
+            const auto [begin, end] = detail::blockBounds(block, numBlocks, len);
+            partials[block].value = std::accumulate(first + begin + 1, first + end, T(first[begin]), op);
+        });
+
+        for (auto& partial : partials) init = op(std::move(init), std::move(partial.value));
+        return init;
+    }
+
+    template <std::random_access_iterator Itr, typename T, typename BinaryOp = std::plus<>>
+    T parallel_reduce(Itr first, Itr last, T init, BinaryOp op = {}, size_t grain = DEFAULT_GRAIN) {
+        return parallel_reduce(ThreadPool::global(), first, last, std::move(init), std::move(op), grain);
+    }
+
+    // Two passes: reduce every block, scan the block totals serially, then scan every block again seeded with the
+    // total of the blocks before it
+    template <std::random_access_iterator Itr, std::random_access_iterator OutItr, typename BinaryOp = std::plus<>>
+    OutItr parallel_inclusive_scan(ThreadPool& pool, Itr first, Itr last, OutItr dFirst, BinaryOp op = {},
+                                   size_t grain = DEFAULT_GRAIN) {
+        using T = std::iter_value_t<Itr>;
+        const auto len = static_cast<size_t>(std::distance(first, last));
+        if (len == 0) return dFirst;
+
+        const auto numBlocks = detail::blockCount(pool, len, grain);
+        if (numBlocks == 1) return std::inclusive_scan(first, last, dFirst, op);
+
+        std::vector<Padded<T>> totals(numBlocks);
+        parallel_for(pool, size_t{0}, numBlocks - 1, [&](size_t block) {
+            const auto [begin, end] = detail::blockBounds(block, numBlocks, len);
+            totals[block].value = std::accumulate(first + begin + 1, first + end, T(first[begin]), op);
+        });
+
+        for (size_t block{1}; block < numBlocks - 1; block++)
+            totals[block].value = op(totals[block - 1].value, totals[block].value);
+
+        parallel_for(pool, size_t{0}, numBlocks, [&](size_t block) {
+            const auto [begin, end] = detail::blockBounds(block, numBlocks, len);
+            if (block == 0)
+                std::inclusive_scan(first + begin, first + end, dFirst + begin, op);
+            else
+                std::inclusive_scan(first + begin, first + end, dFirst + begin, op, totals[block - 1].value);
+        });
+
+        return dFirst + len;
+    }
+
+    template <std::random_access_iterator Itr, std::random_access_iterator OutItr, typename BinaryOp = std::plus<>>
+    OutItr parallel_inclusive_scan(Itr first, Itr last, OutItr dFirst, BinaryOp op = {}, size_t grain = DEFAULT_GRAIN) {
+        return parallel_inclusive_scan(ThreadPool::global(), first, last, dFirst, std::move(op), grain);
+    }
+
+    template <std::random_access_iterator Itr, std::random_access_iterator OutItr, typename UnaryOp>
+    OutItr parallel_transform(ThreadPool& pool, Itr first, Itr last, OutItr dFirst, UnaryOp op,
+                              size_t grain = DEFAULT_GRAIN) {
+        const auto len = static_cast<size_t>(std::distance(first, last));
+        parallel_for_blocks(pool, size_t{0}, len, grain, [&](size_t begin, size_t end) {
+            std::transform(first + begin, first + end, dFirst + begin, op);
+        });
+        return dFirst + len;
+    }
+
+    template <std::random_access_iterator Itr, std::random_access_iterator OutItr, typename UnaryOp>
+    OutItr parallel_transform(Itr first, Itr last, OutItr dFirst, UnaryOp op, size_t grain = DEFAULT_GRAIN) {
+        return parallel_transform(ThreadPool::global(), first, last, dFirst, std::move(op), grain);
+    }
+
+    template <std::random_access_iterator Itr, typename Fn>
+    void parallel_for_each(ThreadPool& pool, Itr first, Itr last, Fn fn, size_t grain = DEFAULT_GRAIN) {
+        const auto len = static_cast<size_t>(std::distance(first, last));
+        parallel_for_blocks(pool, size_t{0}, len, grain,
+                            [&](size_t begin, size_t end) { std::for_each(first + begin, first + end, fn); });
+    }
+
+    template <std::random_access_iterator Itr, typename Fn>
+    void parallel_for_each(Itr first, Itr last, Fn fn, size_t grain = DEFAULT_GRAIN) {
+        parallel_for_each(ThreadPool::global(), first, last, std::move(fn), grain);
+    }
+
+    // Sorts every block independently then merges neighbouring runs pairwise, doubling the run length each round
+    template <std::random_access_iterator Itr, typename Compare = std::less<>>
+    void parallel_sort(ThreadPool& pool, Itr first, Itr last, Compare comp = {}, size_t grain = DEFAULT_GRAIN) {
+        const auto len = static_cast<size_t>(std::distance(first, last));
+        const auto numBlocks = detail::blockCount(pool, len, grain);
+        if (numBlocks == 1) {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        std::vector<size_t> bounds(numBlocks + 1);
+        for (size_t block{}; block <= numBlocks; block++) bounds[block] = block * len / numBlocks;
+
+        parallel_for(pool, size_t{0}, numBlocks,
+                     [&](size_t block) { std::sort(first + bounds[block], first + bounds[block + 1], comp); });
+
+        for (size_t width{1}; width < numBlocks; width *= 2) {
+            const size_t numMerges{(numBlocks + 2 * width - 1) / (2 * width)};
+            parallel_for(pool, size_t{0}, numMerges, [&](size_t merge) {
+                const auto lo = merge * 2 * width;
+                const auto mid = std::min(lo + width, numBlocks);
+                const auto hi = std::min(lo + 2 * width, numBlocks);
+                if (mid == hi) return;
+                std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], comp);
+            });
+        }
+    }
+
+    template <std::random_access_iterator Itr, typename Compare = std::less<>>
+    void parallel_sort(Itr first, Itr last, Compare comp = {}, size_t grain = DEFAULT_GRAIN) {
+        parallel_sort(ThreadPool::global(), first, last, std::move(comp), grain);
+    }
+
+}  // namespace mts::concurrency
@@ -1,28 +1,141 @@
 #include "prime.hpp"
 
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace {
+    constexpr size_t SEGMENT_WORDS{(32 * 1024) / sizeof(uint64_t)};
+    constexpr int64_t SEGMENT_SPAN{static_cast<int64_t>(SEGMENT_WORDS) * 64 * 2};
+
+    constexpr std::array<uint32_t, 5> WHEEL_PRIMES{3, 5, 7, 11, 13};
+
+    // masks[k][r] marks the odd multiples of WHEEL_PRIMES[k] in a word whose first number is r mod p
+    struct WheelMasks {
+        WheelMasks() {
+            for (size_t k{}; k < WHEEL_PRIMES.size(); k++) {
+                const auto p = WHEEL_PRIMES[k];
+                masks[k].resize(p);
+                for (uint32_t r{}; r < p; r++) {
+                    uint64_t mask{};
+                    for (uint32_t bit{}; bit < 64; bit++) {
+                        if ((r + 2 * bit) % p == 0) mask |= uint64_t{1} << bit;
+                    }
+                    masks[k][r] = mask;
+                }
+            }
+        }
+
+        std::array<std::vector<uint64_t>, WHEEL_PRIMES.size()> masks;
+    };
+
+    const WheelMasks& wheelMasks() {
+        static const WheelMasks masks;
+        return masks;
+    }
+
+    // Odd primes above the wheel up to and including max, found with a plain sieve
+    std::vector<uint32_t> smallPrimes(uint32_t max) {
+        std::vector<bool> composite(max + 1);
+        std::vector<uint32_t> res;
+        for (uint32_t i{3}; i <= max; i += 2) {
+            if (composite[i]) continue;
+            if (i > WHEEL_PRIMES.back()) res.push_back(i);
+            for (auto j = static_cast<uint64_t>(i) * i; j <= max; j += 2 * i) composite[j] = true;
+        }
+        return res;
+    }
+}  // namespace
+
+PrimeNumberIterator::PrimeNumberIterator(int max) : limit{max} {
+    if (limit < 3) return;
+    sievingPrimes = smallPrimes(static_cast<uint32_t>(std::sqrt(static_cast<double>(limit))) + 1);
+    nextMultiple.reserve(sievingPrimes.size());
+    for (auto p : sievingPrimes) nextMultiple.push_back(static_cast<uint64_t>(p) * p);
+    segment.resize(SEGMENT_WORDS);
+}
+
+void PrimeNumberIterator::sieveSegment() {
+    const auto high = low + SEGMENT_SPAN;
+    const auto& masks = wheelMasks().masks;
+
+    // Pre-sieve the wheel primes, the residue of each word's first number advances by 128 per word
+    std::array<uint32_t, WHEEL_PRIMES.size()> residues;
+    for (size_t k{}; k < WHEEL_PRIMES.size(); k++) residues[k] = low % WHEEL_PRIMES[k];
+    for (auto& w : segment) {
+        uint64_t composite{};
+        for (size_t k{}; k < WHEEL_PRIMES.size(); k++) {
+            composite |= masks[k][residues[k]];
+            residues[k] = (residues[k] + 128) % WHEEL_PRIMES[k];
+        }
+        w = composite;
+    }
+
+    // The wheel primes are multiples of themselves
+    for (auto p : WHEEL_PRIMES) {
+        if (p >= low && p < high) {
+            const auto bit = static_cast<uint64_t>(p - low) / 2;
+            segment[bit / 64] &= ~(uint64_t{1} << (bit % 64));
+        }
+    }
+
+    for (size_t k{}; k < sievingPrimes.size(); k++) {
+        const uint64_t step = 2 * static_cast<uint64_t>(sievingPrimes[k]);
+        auto m = nextMultiple[k];
+        if (m >= static_cast<uint64_t>(high)) continue;
+        for (; m < static_cast<uint64_t>(high); m += step) {
+            const auto bit = (m - low) / 2;
+            segment[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+        nextMultiple[k] = m;
+    }
+
+    // Everything past the limit counts as composite so iteration stops there
+    if (high > limit + 1) {
+        const auto lastBit = limit >= low ? static_cast<uint64_t>(limit - low) / 2 + 1 : 0;
+        for (auto bit = lastBit; bit < SEGMENT_WORDS * 64 && bit % 64 != 0; bit++)
+            segment[bit / 64] |= uint64_t{1} << (bit % 64);
+        for (auto i = (lastBit + 63) / 64; i < SEGMENT_WORDS; i++) segment[i] = ~uint64_t{0};
+    }
+
+    wordIndex = 0;
+    word = ~segment[0];
+}
+
 bool PrimeNumberIterator::operator!=(int x) const { return x >= current; }
 
 PrimeNumberIterator& PrimeNumberIterator::operator++() {
-    for (auto i = current + 1;; i++) {
-        auto is_prime = true;
-        for (auto j = 2; j < i; j++) {
-            if (i % j == 0) {
-                is_prime = false;
-                break;
-            }
+    if (current == 2) {
+        if (limit < 3) {
+            current = limit + 1;
+            return *this;
         }
-        if (is_prime) {
-            current = i;
-            break;
+        sieveSegment();
+    }
+
+    while (word == 0) {
+        if (++wordIndex < SEGMENT_WORDS) {
+            word = ~segment[wordIndex];
+            continue;
         }
+        low += SEGMENT_SPAN;
+        if (low > limit) {
+            current = limit + 1;
+            return *this;
+        }
+        sieveSegment();
     }
+
+    const auto bit = static_cast<uint64_t>(std::countr_zero(word));
+    word &= word - 1;
+    current = low + 2 * static_cast<int64_t>(wordIndex * 64 + bit);
     return *this;
 }
 
-int PrimeNumberIterator::operator*() const { return current; }
+int PrimeNumberIterator::operator*() const { return static_cast<int>(current); }
 
 PrimeNumberRange::PrimeNumberRange(int max) : max{max} {};
 
-PrimeNumberIterator PrimeNumberRange::begin() const { return PrimeNumberIterator{}; }
+PrimeNumberIterator PrimeNumberRange::begin() const { return PrimeNumberIterator{max}; }
 
 int PrimeNumberRange::end() const { return max; }
@@ -1,12 +1,32 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Primes are produced lazily, one segment of a segmented Sieve of Eratosthenes at a time
+// Segments only hold odd numbers, one bit each, and are sized to stay in L1. Multiples of 3 through 13 are
+// removed with precomputed wheel masks before the remaining sieving primes are crossed off.
 struct PrimeNumberIterator {
+    explicit PrimeNumberIterator(int max);
     bool operator!=(int) const;
     PrimeNumberIterator& operator++();
     int operator*() const;
 
    private:
-    int current{2};
+    void sieveSegment();
+
+    int64_t current{2};
+    int64_t limit;
+    // First odd number of the current segment
+    int64_t low{3};
+    size_t wordIndex{};
+    // Primes of segment[wordIndex] that have not been visited yet
+    uint64_t word{};
+    // Set bits are composites
+    std::vector<uint64_t> segment;
+    std::vector<uint32_t> sievingPrimes;
+    std::vector<uint64_t> nextMultiple;
 };
 
 struct PrimeNumberRange {
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace mts::concurrency {
+
+    // Tells the core we are spinning, frees pipeline resources for the sibling hyper-thread and avoids the memory
+    // order violation flush when the lock is released
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
+    // Exponential backoff, falls back to yielding once spinning stops paying off
+    class Backoff {
+       public:
+        void operator()() {
+            if (spins <= MAX_SPINS) {
+                for (uint32_t i{}; i < spins; i++) cpuRelax();
+                spins *= 2;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        void reset() { spins = 1; }
+
+       private:
+        static constexpr uint32_t MAX_SPINS{64};
+        uint32_t spins{1};
+    };
+
+    // Test and test and set lock
+    // Waiters spin on a plain load so the cache line stays shared until the holder releases it
+    class SpinLock {
+       public:
+        SpinLock() = default;
+        SpinLock(const SpinLock& other) = delete;
+        SpinLock& operator=(const SpinLock& other) = delete;
+
+        void lock() {
+            Backoff backoff;
+            while (true) {
+                if (!locked.exchange(true, std::memory_order_acquire)) return;
+                while (locked.load(std::memory_order_relaxed)) backoff();
+            }
+        }
+
+        bool try_lock() {
+            return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() { locked.store(false, std::memory_order_release); }
+
+       private:
+        alignas(64) std::atomic_bool locked{false};
+    };
+
+    // FIFO ticket lock, waiters are served in arrival order
+    class TicketLock {
+       public:
+        TicketLock() = default;
+        TicketLock(const TicketLock& other) = delete;
+        TicketLock& operator=(const TicketLock& other) = delete;
+
+        void lock() {
+            const auto ticket = next.fetch_add(1, std::memory_order_relaxed);
+            Backoff backoff;
+            while (serving.load(std::memory_order_acquire) != ticket) backoff();
+        }
+
+        bool try_lock() {
+            auto current = serving.load(std::memory_order_relaxed);
+            return next.compare_exchange_strong(current, current + 1, std::memory_order_acquire,
+                                                std::memory_order_relaxed);
+        }
+
+        // Only the holder writes serving so a plain increment is enough
+        void unlock() {
+            serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+       private:
+        alignas(64) std::atomic_uint32_t next{0};
+        alignas(64) std::atomic_uint32_t serving{0};
+    };
+
+    // MCS queue lock, every waiter spins on its own node so a release only touches the successor's cache line
+    class McsLock {
+       public:
+        struct Node {
+            std::atomic<Node*> next{nullptr};
+            std::atomic_bool locked{false};
+        };
+
+        // Holds its own queue node, preferred over lock()/unlock()
+        class ScopedLock {
+           public:
+            explicit ScopedLock(McsLock& mcs) : mcs{mcs} { mcs.lock(node); }
+            ~ScopedLock() { mcs.unlock(node); }
+            ScopedLock(const ScopedLock& other) = delete;
+            ScopedLock& operator=(const ScopedLock& other) = delete;
+
+           private:
+            McsLock& mcs;
+            alignas(64) Node node;
+        };
+
+        McsLock() = default;
+        McsLock(const McsLock& other) = delete;
+        McsLock& operator=(const McsLock& other) = delete;
+
+        void lock(Node& node) {
+            node.next.store(nullptr, std::memory_order_relaxed);
+            node.locked.store(true, std::memory_order_relaxed);
+
+            auto* prev = tail.exchange(&node, std::memory_order_acq_rel);
+            if (!prev) return;
+
+            prev->next.store(&node, std::memory_order_release);
+            Backoff backoff;
+            while (node.locked.load(std::memory_order_acquire)) backoff();
+        }
+
+        bool try_lock(Node& node) {
+            node.next.store(nullptr, std::memory_order_relaxed);
+            Node* expected{nullptr};
+            return tail.compare_exchange_strong(expected, &node, std::memory_order_acquire,
+                                                std::memory_order_relaxed);
+        }
+
+        void unlock(Node& node) {
+            auto* succ = node.next.load(std::memory_order_acquire);
+            if (!succ) {
+                auto* expected = &node;
+                if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release,
+                                                 std::memory_order_relaxed))
+                    return;
+                // A successor swapped itself into tail but has not linked itself yet
+                while (!(succ = node.next.load(std::memory_order_acquire))) cpuRelax();
+            }
+            succ->locked.store(false, std::memory_order_release);
+        }
+
+        // BasicLockable interface for std::lock_guard and friends
+        // Nodes come from a small per-thread stack so nested acquisitions must be released in reverse order
+        void lock() { lock(pushNode()); }
+        bool try_lock() {
+            auto& node = pushNode();
+            if (try_lock(node)) return true;
+            popNode();
+            return false;
+        }
+        void unlock() { unlock(popNode()); }
+
+       private:
+        static constexpr size_t MAX_NESTING{8};
+        struct NodeStack {
+            Node nodes[MAX_NESTING];
+            size_t depth{};
+        };
+
+        static NodeStack& nodeStack() {
+            thread_local NodeStack stack;
+            return stack;
+        }
+
+        static Node& pushNode() {
+            auto& stack = nodeStack();
+            if (stack.depth == MAX_NESTING) throw std::logic_error("McsLock nested too deeply");
+            return stack.nodes[stack.depth++];
+        }
+
+        static Node& popNode() {
+            auto& stack = nodeStack();
+            return stack.nodes[--stack.depth];
+        }
+
+        alignas(64) std::atomic<Node*> tail{nullptr};
+    };
+
+    // Writer preferring reader-writer spin lock, usable with std::shared_lock
+    // Layout: bit 0 is the writer, bit 1 a waiting writer and the remaining bits the reader count
+    class RwSpinLock {
+       public:
+        RwSpinLock() = default;
+        RwSpinLock(const RwSpinLock& other) = delete;
+        RwSpinLock& operator=(const RwSpinLock& other) = delete;
+
+        void lock() {
+            Backoff backoff;
+            while (true) {
+                auto s = state.load(std::memory_order_relaxed);
+                if ((s & ~WAITING) == 0) {
+                    if (state.compare_exchange_weak(s, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+                        return;
+                } else if (!(s & WAITING)) {
+                    // Stop new readers from getting in
+                    state.fetch_or(WAITING, std::memory_order_relaxed);
+                }
+                backoff();
+            }
+        }
+
+        bool try_lock() {
+            auto s = state.load(std::memory_order_relaxed);
+            return (s & ~WAITING) == 0 &&
+                   state.compare_exchange_strong(s, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() { state.fetch_and(~(WRITER | WAITING), std::memory_order_release); }
+
+        void lock_shared() {
+            Backoff backoff;
+            while (!try_lock_shared()) backoff();
+        }
+
+        bool try_lock_shared() {
+            if (state.load(std::memory_order_relaxed) & (WRITER | WAITING)) return false;
+            const auto s = state.fetch_add(READER, std::memory_order_acquire);
+            if (s & WRITER) {
+                state.fetch_sub(READER, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        void unlock_shared() { state.fetch_sub(READER, std::memory_order_release); }
+
+       private:
+        static constexpr uint32_t WRITER{1};
+        static constexpr uint32_t WAITING{2};
+        static constexpr uint32_t READER{4};
+
+        alignas(64) std::atomic_uint32_t state{0};
+    };
+
+}  // namespace mts::concurrency
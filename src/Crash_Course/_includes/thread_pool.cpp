@@ -0,0 +1,100 @@
+#include "thread_pool.hpp"
+
+namespace mts::concurrency {
+
+    thread_local ThreadPool* ThreadPool::currentPool{nullptr};
+    thread_local size_t ThreadPool::currentIndex{0};
+
+    ThreadPool::ThreadPool(size_t numThreads) {
+        numThreads = std::max<size_t>(numThreads, 1);
+        queues.reserve(numThreads);
+        for (size_t i{}; i < numThreads; i++) queues.emplace_back(new WorkStealingDeque<Task*>{});
+
+        workers.reserve(numThreads);
+        for (size_t i{}; i < numThreads; i++) workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::scoped_lock lock{sleepMutex};
+            stopping = true;
+        }
+        sleepCv.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool& ThreadPool::global() {
+        static ThreadPool pool{};
+        return pool;
+    }
+
+    void ThreadPool::enqueue(Task* task) {
+        if (isWorker()) {
+            queues[currentIndex]->push(task);
+        } else {
+            std::scoped_lock lock{injectionMutex};
+            injection.push_back(task);
+        }
+
+        pending.fetch_add(1, std::memory_order_release);
+        // Taking the mutex orders this notify after any worker that is between checking pending and sleeping
+        { std::scoped_lock lock{sleepMutex}; }
+        sleepCv.notify_one();
+    }
+
+    Task* ThreadPool::stealTask(size_t startIndex) {
+        const auto n = queues.size();
+        for (size_t i{}; i < n; i++) {
+            if (auto* task = queues[(startIndex + i) % n]->steal()) return task;
+        }
+        return nullptr;
+    }
+
+    Task* ThreadPool::findTask(size_t index) {
+        Task* task{nullptr};
+        if (isWorker()) task = queues[index]->pop();
+
+        if (!task) {
+            std::scoped_lock lock{injectionMutex};
+            if (!injection.empty()) {
+                task = injection.front();
+                injection.pop_front();
+            }
+        }
+
+        if (!task) task = stealTask(index + 1);
+
+        if (task) pending.fetch_sub(1, std::memory_order_acq_rel);
+        return task;
+    }
+
+    void ThreadPool::run(Task* task) {
+        std::unique_ptr<Task> owned{task};
+        (*owned)();
+    }
+
+    bool ThreadPool::runPendingTask() {
+        const auto index = isWorker() ? currentIndex : std::hash<std::thread::id>{}(std::this_thread::get_id());
+        auto* task = findTask(index % queues.size());
+        if (!task) return false;
+        run(task);
+        return true;
+    }
+
+    void ThreadPool::workerLoop(size_t index) {
+        currentPool = this;
+        currentIndex = index;
+
+        while (true) {
+            if (auto* task = findTask(index)) {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock lock{sleepMutex};
+            if (stopping && pending.load(std::memory_order_acquire) <= 0) return;
+            sleepCv.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+        }
+    }
+
+}  // namespace mts::concurrency
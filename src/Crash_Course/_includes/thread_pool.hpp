@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mts::concurrency {
+
+    using Task = std::move_only_function<void()>;
+
+    // Chase-Lev work stealing deque (Le et al. "Correct and Efficient Work-Stealing for Weak Memory Models")
+    // The owning thread pushes and pops at the bottom, every other thread steals from the top
+    template <typename T>
+        requires std::is_pointer_v<T>
+    class WorkStealingDeque {
+        struct Buffer {
+            explicit Buffer(int64_t capacity)
+                : capacity{capacity}, mask{capacity - 1}, slots{new std::atomic<T>[static_cast<size_t>(capacity)]} {}
+
+            [[nodiscard]] T load(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+            void store(int64_t i, T x) { slots[i & mask].store(x, std::memory_order_relaxed); }
+
+            Buffer* grow(int64_t bottom, int64_t top) const {
+                auto* res = new Buffer{capacity * 2};
+                for (int64_t i{top}; i < bottom; i++) res->store(i, load(i));
+                return res;
+            }
+
+            const int64_t capacity;
+            const int64_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+        };
+
+       public:
+        explicit WorkStealingDeque(int64_t capacity = 256) : buffer{new Buffer{capacity}} {}
+        WorkStealingDeque(const WorkStealingDeque& other) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+        ~WorkStealingDeque() { delete buffer.load(std::memory_order_relaxed); }
+
+        // Owner only
+        void push(T x) {
+            const auto b = bottom.load(std::memory_order_relaxed);
+            const auto t = top.load(std::memory_order_acquire);
+            auto* buf = buffer.load(std::memory_order_relaxed);
+            if (b - t > buf->capacity - 1) {
+                // Thieves may still be reading the old buffer so it is retired instead of freed
+                retired.emplace_back(buf);
+                buf = buf->grow(b, t);
+                buffer.store(buf, std::memory_order_release);
+            }
+            buf->store(b, x);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        // Owner only, returns nullptr when empty
+        T pop() {
+            const auto b = bottom.load(std::memory_order_relaxed) - 1;
+            auto* buf = buffer.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T x = buf->load(b);
+            if (t == b) {
+                // Last element, race against thieves for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    x = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return x;
+        }
+
+        // Any thread, returns nullptr when empty or when the race was lost
+        T steal() {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto b = bottom.load(std::memory_order_acquire);
+            if (t >= b) return nullptr;
+
+            auto* buf = buffer.load(std::memory_order_acquire);
+            T x = buf->load(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return x;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+
+       private:
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        alignas(64) std::atomic<Buffer*> buffer;
+        std::vector<std::unique_ptr<Buffer>> retired;
+    };
+
+    // Work stealing thread pool
+    // Each worker owns a Chase-Lev deque, tasks spawned from a worker go to its own deque and tasks submitted from
+    // outside go through a shared injection queue. Idle workers steal from each other before going to sleep.
+    // Waiting on a future through wait() runs other queued tasks in the meantime so tasks can spawn and wait on
+    // subtasks without deadlocking the pool.
+    class ThreadPool {
+       public:
+        explicit ThreadPool(size_t numThreads = defaultConcurrency());
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ~ThreadPool();
+
+        template <typename Fn, typename... Args>
+        auto submit(Fn&& fn, Args&&... args)
+            -> std::future<std::invoke_result_t<std::decay_t<Fn>, std::decay_t<Args>...>>;
+
+        // Fire and forget, exceptions thrown by fn terminate the program
+        template <typename Fn>
+        void post(Fn&& fn) {
+            enqueue(new Task{std::forward<Fn>(fn)});
+        }
+
+        // Blocks until the future is ready, executing pending tasks while waiting
+        template <typename T>
+        T wait(std::future<T>& future);
+
+        // Runs a single pending task on the calling thread, returns false if none could be found
+        bool runPendingTask();
+
+        [[nodiscard]] size_t size() const { return workers.size(); }
+
+        // Whether the calling thread is one of this pool's workers
+        [[nodiscard]] bool isWorker() const { return currentPool == this; }
+
+        // Process wide pool sized to the hardware concurrency
+        static ThreadPool& global();
+
+        static size_t defaultConcurrency() {
+            const auto n = std::thread::hardware_concurrency();
+            return n == 0 ? 2 : n;
+        }
+
+       private:
+        void enqueue(Task* task);
+        void workerLoop(size_t index);
+        Task* findTask(size_t index);
+        Task* stealTask(size_t startIndex);
+        void run(Task* task);
+
+        std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex injectionMutex;
+        std::deque<Task*> injection;
+
+        std::atomic<int64_t> pending{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCv;
+        bool stopping{false};
+
+        static thread_local ThreadPool* currentPool;
+        static thread_local size_t currentIndex;
+    };
+
+    template <typename Fn, typename... Args>
+    auto ThreadPool::submit(Fn&& fn, Args&&... args)
+        -> std::future<std::invoke_result_t<std::decay_t<Fn>, std::decay_t<Args>...>> {
+        using Result = std::invoke_result_t<std::decay_t<Fn>, std::decay_t<Args>...>;
+
+        std::packaged_task<Result()> task{
+            [fn = std::forward<Fn>(fn), ... args = std::forward<Args>(args)]() mutable -> Result {
+                return std::invoke(std::move(fn), std::move(args)...);
+            }};
+        auto future = task.get_future();
+        enqueue(new Task{std::move(task)});
+        return future;
+    }
+
+    template <typename T>
+    T ThreadPool::wait(std::future<T>& future) {
+        using namespace std::chrono_literals;
+        while (future.wait_for(0s) != std::future_status::ready) {
+            if (!runPendingTask()) std::this_thread::yield();
+        }
+        return future.get();
+    }
+
+    // Splits [first, last) into blocks of at least grain indices and calls fn(blockFirst, blockLast) for each
+    // block on the pool. The calling thread runs blocks too and returns once every block is done, rethrowing the
+    // first exception thrown by fn.
+    template <std::integral Index, typename Fn>
+    void parallel_for_blocks(ThreadPool& pool, Index first, Index last, size_t grain, Fn&& fn) {
+        if (last <= first) return;
+        const auto len = static_cast<size_t>(last - first);
+
+        // A few blocks per worker so stealing can even out uneven blocks
+        const size_t maxBlocks{(pool.size() + 1) * 4};
+        grain = std::max<size_t>({grain, 1, (len + maxBlocks - 1) / maxBlocks});
+        const size_t numBlocks{(len + grain - 1) / grain};
+
+        if (numBlocks == 1) {
+            fn(first, last);
+            return;
+        }
+
+        std::atomic<size_t> remaining{numBlocks - 1};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto runBlock = [&](size_t block) {
+            const auto blockFirst = static_cast<Index>(first + block * grain);
+            const auto blockLast = static_cast<Index>(first + std::min(len, (block + 1) * grain));
+            try {
+                fn(blockFirst, blockLast);
+            } catch (...) {
+                std::scoped_lock lock{errorMutex};
+                if (!error) error = std::current_exception();
+            }
+        };
+
+        for (size_t block{1}; block < numBlocks; block++) {
+            pool.post([&runBlock, &remaining, block] {
+                runBlock(block);
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        runBlock(0);
+
+        while (remaining.load(std::memory_order_acquire) != 0) {
+            if (!pool.runPendingTask()) std::this_thread::yield();
+        }
+
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Calls fn(i) for every i in [first, last) on the pool
+    template <std::integral Index, typename Fn>
+    void parallel_for(ThreadPool& pool, Index first, Index last, Fn&& fn, size_t grain = 1) {
+        parallel_for_blocks(pool, first, last, grain, [&fn](Index blockFirst, Index blockLast) {
+            for (auto i{blockFirst}; i < blockLast; i++) fn(i);
+        });
+    }
+
+    template <std::integral Index, typename Fn>
+    void parallel_for(Index first, Index last, Fn&& fn, size_t grain = 1) {
+        parallel_for(ThreadPool::global(), first, last, std::forward<Fn>(fn), grain);
+    }
+
+}  // namespace mts::concurrency
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <execution>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "parallel_algorithms.hpp"
+#include "timer.hpp"
+
+using namespace std;
+using namespace mts::concurrency;
+
+// Pool algorithms against execution::seq and execution::par (TBB backed) on the same inputs
+const size_t N{10'000'000};
+
+vector<long> make_random_vector() {
+    vector<long> numbers(N);
+    iota(numbers.begin(), numbers.end(), 0);
+    mt19937_64 urng{121216};
+    shuffle(numbers.begin(), numbers.end(), urng);
+    return numbers;
+}
+
+template <typename Fn>
+chrono::nanoseconds measure(string_view name, Fn&& fn) {
+    chrono::nanoseconds duration{};
+    {
+        TimerClass timer{string{name}, &duration};
+        fn();
+    }
+    return duration;
+}
+
+void report(string_view algorithm, chrono::nanoseconds seq, chrono::nanoseconds par, chrono::nanoseconds pool) {
+    using chrono::duration_cast, chrono::microseconds;
+    cout << format("{:<16} seq: {:>10} std par: {:>10} pool: {:>10} ({:.2f}x vs std par)\n", algorithm,
+                   duration_cast<microseconds>(seq), duration_cast<microseconds>(par),
+                   duration_cast<microseconds>(pool), static_cast<double>(par.count()) / pool.count());
+}
+
+int main() {
+    auto& pool = ThreadPool::global();
+    const auto numbers = make_random_vector();
+    vector<long> out(N);
+    long sink{};
+
+    cout << "Elements: " << N << " Pool workers: " << pool.size() << "\n";
+
+    // Warm up the pool threads and the TBB scheduler so neither pays startup in the first measurement
+    sink += parallel_reduce(pool, numbers.begin(), numbers.end(), 0L);
+    sink += reduce(execution::par, numbers.begin(), numbers.end(), 0L);
+
+    {
+        auto seq = measure("seq", [&] { sink += reduce(execution::seq, numbers.begin(), numbers.end(), 0L); });
+        auto par = measure("par", [&] { sink += reduce(execution::par, numbers.begin(), numbers.end(), 0L); });
+        auto mine = measure("pool", [&] { sink += parallel_reduce(pool, numbers.begin(), numbers.end(), 0L); });
+        report("reduce", seq, par, mine);
+    }
+
+    {
+        const auto first = numbers.begin(), last = numbers.end();
+        auto seq = measure("seq", [&] { inclusive_scan(execution::seq, first, last, out.begin()); });
+        auto par = measure("par", [&] { inclusive_scan(execution::par, first, last, out.begin()); });
+        auto mine = measure("pool", [&] { parallel_inclusive_scan(pool, first, last, out.begin()); });
+        report("inclusive_scan", seq, par, mine);
+    }
+
+    {
+        auto square = [](long x) { return x * x; };
+        const auto first = numbers.begin(), last = numbers.end();
+        auto seq = measure("seq", [&] { transform(execution::seq, first, last, out.begin(), square); });
+        auto par = measure("par", [&] { transform(execution::par, first, last, out.begin(), square); });
+        auto mine = measure("pool", [&] { parallel_transform(pool, first, last, out.begin(), square); });
+        report("transform", seq, par, mine);
+    }
+
+    {
+        auto bump = [](long& x) { x = x * 3 + 1; };
+        auto seq = measure("seq", [&] { for_each(execution::seq, out.begin(), out.end(), bump); });
+        auto par = measure("par", [&] { for_each(execution::par, out.begin(), out.end(), bump); });
+        auto mine = measure("pool", [&] { parallel_for_each(pool, out.begin(), out.end(), bump); });
+        report("for_each", seq, par, mine);
+    }
+
+    {
+        auto a{numbers}, b{numbers}, c{numbers};
+        auto seq = measure("seq", [&] { sort(execution::seq, a.begin(), a.end()); });
+        auto par = measure("par", [&] { sort(execution::par, b.begin(), b.end()); });
+        auto mine = measure("pool", [&] { parallel_sort(pool, c.begin(), c.end()); });
+        report("sort", seq, par, mine);
+        if (a != c) cout << "parallel_sort result differs from sort\n";
+    }
+
+    cout << "(" << sink << ")\n";
+}
@@ -8,24 +8,22 @@
 #include <string>
 #include <vector>
 
+#include "factor.hpp"
 #include "stopwatch.hpp"
+#include "thread_pool.hpp"
 #include "timer.hpp"
 
 namespace chrono = std::chrono;
 using std::string, std::stringstream, std::multiset, std::set, std::cout, std::endl, std::vector, std::future,
     std::launch, std::async, std::future_status;
+using mts::concurrency::ThreadPool;
 
+// Distinct prime factors of x along with 1
 template <typename T>
 set<T> factorize(T x) {
     set<T> res{1};
-
-    for (T candidate{2}; candidate <= x; candidate++) {
-        if (x % candidate == 0) {
-            res.insert(candidate);
-            x /= candidate;
-            candidate = 1;
-        }
-    }
+    const auto factors = Factor::primeFactors(static_cast<Factor::u64>(x));
+    res.insert(factors.begin(), factors.end());
     return res;
 }
 
@@ -37,26 +35,30 @@ string factor_task(unsigned long long x) {
         factors = factorize(x);
     }
 
-    const auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(elapsed_ns).count();
+    const auto elapsed_us = chrono::duration_cast<chrono::microseconds>(elapsed_ns).count();
     stringstream ss;
-    ss << elapsed_ms << " ms: Factoring " << x << "( ";
+    ss << elapsed_us << " us: Factoring " << x << "( ";
     for (auto factor : factors) ss << factor << " ";
     ss << ")\n";
 
     return ss.str();
 }
 
-std::array<unsigned long long, 6> numbers{9'699'690,     179'426'549,   1'000'000'007,
-                                          4'294'967'291, 4'294'967'296, 1'307'674'368'000};
+std::array<unsigned long long, 8> numbers{9'699'690,     179'426'549,       1'000'000'007,
+                                          4'294'967'291, 4'294'967'296,     1'307'674'368'000,
+                                          // Semiprime of two 32-bit primes and the largest 64-bit prime
+                                          18'446'743'979'220'271'189ULL, 18'446'744'073'709'551'557ULL};
 
 int main() {
     // chrono::nanoseconds elapsed_ns;
     {
         // Stopwatch stopwatch{elapsed_ns};
         TimerClass timer{"Timer"};
+        auto& pool = ThreadPool::global();
         vector<future<string>> factor_tasks;
         // for (auto number : numbers) factor_tasks.emplace_back(async(launch::async, factor_task, number));
-        auto worker = [](auto number) { return async(launch::async, factor_task, number); };
+        // auto worker = [](auto number) { return async(launch::async, factor_task, number); };
+        auto worker = [&pool](auto number) { return pool.submit(factor_task, number); };
         std::transform(numbers.begin(), numbers.end(), std::back_inserter(factor_tasks), worker);
 
         for (auto& task : factor_tasks) cout << task.get();
@@ -0,0 +1,78 @@
+#include <array>
+#include <chrono>
+#include <format>
+#include <future>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "factor.hpp"
+#include "stopwatch.hpp"
+#include "thread_pool.hpp"
+
+namespace chrono = std::chrono;
+using std::cout, std::vector, std::future, std::string_view;
+using Factor::u64;
+using mts::concurrency::ThreadPool;
+
+const std::array<u64, 6> numbers{9'699'690,     179'426'549,   1'000'000'007,
+                                 4'294'967'291, 4'294'967'296, 1'307'674'368'000};
+
+u64 randomPrime(std::mt19937_64& rng, int bits) {
+    std::uniform_int_distribution<u64> dist{u64{1} << (bits - 1), (u64{1} << bits) - 1};
+    while (true) {
+        const auto candidate = dist(rng) | 1;
+        if (Factor::isPrime(candidate)) return candidate;
+    }
+}
+
+// Balanced semiprimes are the worst case for rho, both factors are about sqrt(n)
+vector<u64> randomSemiprimes(size_t count, std::mt19937_64& rng) {
+    vector<u64> res(count);
+    for (auto& n : res) n = randomPrime(rng, 32) * randomPrime(rng, 32);
+    return res;
+}
+
+// Factors every input as its own pool task, the same fan-out factorize uses
+size_t factorAll(ThreadPool& pool, const vector<u64>& inputs) {
+    vector<future<size_t>> tasks;
+    tasks.reserve(inputs.size());
+    for (auto n : inputs) tasks.push_back(pool.submit([n] { return Factor::primeFactors(n).size(); }));
+
+    size_t totalFactors{};
+    for (auto& task : tasks) totalFactors += pool.wait(task);
+    return totalFactors;
+}
+
+void report(string_view name, size_t count, size_t factors, chrono::nanoseconds elapsed) {
+    const auto seconds = chrono::duration<double>(elapsed).count();
+    cout << std::format("{:<24} {:>7} numbers {:>9.2f} ms {:>12.0f} numbers/s ({} factors)\n", name, count,
+                        seconds * 1e3, static_cast<double>(count) / seconds, factors);
+}
+
+int main() {
+    auto& pool = ThreadPool::global();
+    std::mt19937_64 rng{121216};
+
+    // Repeat the original inputs so the run is long enough to time
+    vector<u64> repeated;
+    for (size_t i{}; i < 1000; i++) repeated.insert(repeated.end(), numbers.begin(), numbers.end());
+
+    const auto semiprimes = randomSemiprimes(10'000, rng);
+
+    vector<u64> uniform(10'000);
+    for (auto& n : uniform) n = rng();
+
+    for (const auto& [name, inputs] : {std::pair<string_view, const vector<u64>&>{"numbers array x1000", repeated},
+                                       {"random 64-bit semiprimes", semiprimes},
+                                       {"random 64-bit integers", uniform}}) {
+        chrono::nanoseconds elapsed{};
+        size_t factors{};
+        {
+            Stopwatch stopwatch{elapsed};
+            factors = factorAll(pool, inputs);
+        }
+        report(name, inputs.size(), factors, elapsed);
+    }
+}
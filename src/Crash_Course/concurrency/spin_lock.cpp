@@ -1,61 +1,107 @@
-#include <atomic>
+#include "spin_lock.hpp"
+
+#include <chrono>
+#include <format>
 #include <future>
 #include <iostream>
 #include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
 
-struct SpinLock {
-    SpinLock() = default;
-    SpinLock(const SpinLock& other) = delete;
-    SpinLock& operator=(const SpinLock& other) = delete;
-
-    void lock() {
-        while (locked.exchange(true, std::memory_order_acquire))
-            ;
-    }
-
-    bool try_lock() {
-        if (!locked) {
-            return true;
-            this->lock();
-        } else
-            return false;
-    }
-
-    void unlock() { locked = false; }
-
-   private:
-    std::atomic_bool locked{false};
-};
+#include "stopwatch.hpp"
 
 using namespace std;
+using mts::concurrency::SpinLock, mts::concurrency::TicketLock, mts::concurrency::McsLock,
+    mts::concurrency::RwSpinLock;
 
-void goat_rodeo() {
-    const size_t iterations{1'000'000};
+// Half the threads deposit cans and the other half eat them, so the count should end up at zero
+template <typename Lock>
+chrono::nanoseconds goat_rodeo(size_t numThreads, size_t iterations = 1'000'000) {
     int tin_cans_available{};
-    SpinLock tin_can_mutex;
+    Lock tin_can_mutex;
+    chrono::nanoseconds elapsed{};
 
-    auto eat_cans = async(launch::async, [&] {
-        for (size_t i{}; i < iterations; i++) {
-            lock_guard<SpinLock> guard{tin_can_mutex};
-            tin_cans_available--;
+    {
+        Stopwatch stopwatch{elapsed};
+        vector<future<void>> goats;
+        for (size_t t{}; t < numThreads; t++) {
+            const int delta = t % 2 == 0 ? 1 : -1;
+            goats.push_back(async(launch::async, [&, delta] {
+                for (size_t i{}; i < iterations / numThreads; i++) {
+                    lock_guard<Lock> guard{tin_can_mutex};
+                    tin_cans_available += delta;
+                }
+            }));
         }
-    });
+        for (auto& goat : goats) goat.get();
+    }
 
-    auto deposit_cans = async(launch::async, [&] {
-        for (size_t i{}; i < iterations; i++) {
-            lock_guard<SpinLock> guard{tin_can_mutex};
-            tin_cans_available++;
-        }
-    });
+    if (tin_cans_available != 0) cout << "Tin cans: " << tin_cans_available << " (race detected)\n";
+    return elapsed;
+}
 
-    eat_cans.get();
-    deposit_cans.get();
+// Most goats only count the cans, one in readEvery eats or deposits
+template <typename Lock>
+chrono::nanoseconds goat_census(size_t numThreads, size_t readEvery = 16, size_t iterations = 1'000'000) {
+    int tin_cans_available{};
+    Lock tin_can_mutex;
+    chrono::nanoseconds elapsed{};
+    atomic_long counted{};
+
+    {
+        Stopwatch stopwatch{elapsed};
+        vector<future<void>> goats;
+        for (size_t t{}; t < numThreads; t++) {
+            goats.push_back(async(launch::async, [&, t] {
+                long seen{};
+                for (size_t i{}; i < iterations / numThreads; i++) {
+                    if (i % readEvery == 0) {
+                        lock_guard<Lock> guard{tin_can_mutex};
+                        tin_cans_available += t % 2 == 0 ? 1 : -1;
+                    } else {
+                        shared_lock<Lock> guard{tin_can_mutex};
+                        seen += tin_cans_available;
+                    }
+                }
+                counted += seen;
+            }));
+        }
+        for (auto& goat : goats) goat.get();
+    }
+    return elapsed;
+}
 
-    cout << "Tin cans: " << tin_cans_available << "\n";
+void report(string_view name, size_t numThreads, chrono::nanoseconds elapsed, size_t iterations = 1'000'000) {
+    const auto nsPerOp = static_cast<double>(elapsed.count()) / static_cast<double>(iterations);
+    cout << format("{:<12} threads: {:>3} {:>10} {:>8.1f} ns/op\n", name, numThreads,
+                   chrono::duration_cast<chrono::microseconds>(elapsed), nsPerOp);
 }
 
 int main() {
-    goat_rodeo();
-    goat_rodeo();
-    goat_rodeo();
+    const size_t hardwareThreads = thread::hardware_concurrency();
+    vector<size_t> threadCounts{2, 4, 8};
+    for (auto n = threadCounts.back() * 2; n <= hardwareThreads * 2; n *= 2) threadCounts.push_back(n);
+
+    cout << "Exclusive goat rodeo\n";
+    for (auto n : threadCounts) {
+        report("std::mutex", n, goat_rodeo<mutex>(n));
+        report("SpinLock", n, goat_rodeo<SpinLock>(n));
+        // FIFO handoff to a descheduled waiter costs a full time slice per acquisition
+        if (n <= hardwareThreads) {
+            report("TicketLock", n, goat_rodeo<TicketLock>(n));
+            report("McsLock", n, goat_rodeo<McsLock>(n));
+        } else {
+            cout << "TicketLock and McsLock skipped, more threads than cores\n";
+        }
+        cout << '\n';
+    }
+
+    cout << "Read mostly goat census\n";
+    for (auto n : threadCounts) {
+        report("shared_mutex", n, goat_census<shared_mutex>(n));
+        report("RwSpinLock", n, goat_census<RwSpinLock>(n));
+        cout << '\n';
+    }
 }
@@ -0,0 +1,60 @@
+#include "factor.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using Factor::u64;
+
+u64 product(const std::vector<u64>& factors) {
+    return std::accumulate(factors.begin(), factors.end(), u64{1}, std::multiplies<>{});
+}
+
+TEST_CASE("Factor::isPrime") {
+    SECTION("agrees with trial division for small n") {
+        for (u64 n{}; n < 10'000; n++) {
+            bool expected = n >= 2;
+            for (u64 d{2}; d * d <= n; d++) {
+                if (n % d == 0) {
+                    expected = false;
+                    break;
+                }
+            }
+            REQUIRE(Factor::isPrime(n) == expected);
+        }
+    }
+
+    SECTION("large primes and strong pseudoprimes") {
+        REQUIRE(Factor::isPrime(1'000'000'007));
+        REQUIRE(Factor::isPrime(4'294'967'291));
+        // 2^64 - 59
+        REQUIRE(Factor::isPrime(18'446'744'073'709'551'557ULL));
+        // Strong pseudoprimes to bases 2 through 7 and 2 through 23
+        REQUIRE_FALSE(Factor::isPrime(3'215'031'751));
+        REQUIRE_FALSE(Factor::isPrime(3'825'123'056'546'413'051ULL));
+        REQUIRE_FALSE(Factor::isPrime(18'446'744'073'709'551'615ULL));
+    }
+}
+
+TEST_CASE("Factor::primeFactors") {
+    REQUIRE(Factor::primeFactors(0).empty());
+    REQUIRE(Factor::primeFactors(1).empty());
+    REQUIRE(Factor::primeFactors(9'699'690) == std::vector<u64>{2, 3, 5, 7, 11, 13, 17, 19});
+    REQUIRE(Factor::primeFactors(4'294'967'296) == std::vector<u64>(32, 2));
+    REQUIRE(Factor::primeFactors(18'446'743'979'220'271'189ULL) == std::vector<u64>{4'294'967'279, 4'294'967'291});
+    // Square of a prime above the trial division limit
+    REQUIRE(Factor::primeFactors(1'000'000'014'000'000'049ULL) == std::vector<u64>{1'000'000'007, 1'000'000'007});
+
+    SECTION("factors of random 64-bit integers are prime and multiply back") {
+        std::mt19937_64 rng{121216};
+        for (int i{}; i < 200; i++) {
+            const auto n = rng();
+            const auto factors = Factor::primeFactors(n);
+            REQUIRE(product(factors) == n);
+            REQUIRE(std::is_sorted(factors.begin(), factors.end()));
+            for (auto p : factors) REQUIRE(Factor::isPrime(p));
+        }
+    }
+}
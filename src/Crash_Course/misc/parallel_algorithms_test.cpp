@@ -0,0 +1,61 @@
+#include "parallel_algorithms.hpp"
+
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace mts::concurrency;
+
+TEST_CASE("parallel algorithms match their sequential counterparts") {
+    ThreadPool pool{4};
+    std::vector<long> numbers(100'003);
+    std::iota(numbers.begin(), numbers.end(), -50'000);
+    std::shuffle(numbers.begin(), numbers.end(), std::mt19937_64{121216});
+    const size_t grain = GENERATE(1, 7, 1000, DEFAULT_GRAIN, 1'000'000);
+
+    SECTION("parallel_reduce") {
+        REQUIRE(parallel_reduce(pool, numbers.begin(), numbers.end(), 10L, std::plus<>{}, grain) ==
+                std::accumulate(numbers.begin(), numbers.end(), 10L));
+        REQUIRE(parallel_reduce(pool, numbers.begin(), numbers.begin(), 10L) == 10L);
+    }
+
+    SECTION("parallel_reduce keeps the order of a non commutative op") {
+        std::vector<std::string> words(1000);
+        for (size_t i{}; i < words.size(); i++) words[i] = std::to_string(i % 10);
+        REQUIRE(parallel_reduce(pool, words.begin(), words.end(), std::string{">"}, std::plus<>{}, grain) ==
+                std::accumulate(words.begin(), words.end(), std::string{">"}));
+    }
+
+    SECTION("parallel_inclusive_scan") {
+        std::vector<long> expected(numbers.size()), actual(numbers.size());
+        std::inclusive_scan(numbers.begin(), numbers.end(), expected.begin());
+        auto end = parallel_inclusive_scan(pool, numbers.begin(), numbers.end(), actual.begin(), std::plus<>{}, grain);
+        REQUIRE(end == actual.end());
+        REQUIRE(actual == expected);
+    }
+
+    SECTION("parallel_transform") {
+        std::vector<long> expected(numbers.size()), actual(numbers.size());
+        auto square = [](long x) { return x * x; };
+        std::transform(numbers.begin(), numbers.end(), expected.begin(), square);
+        parallel_transform(pool, numbers.begin(), numbers.end(), actual.begin(), square, grain);
+        REQUIRE(actual == expected);
+    }
+
+    SECTION("parallel_for_each") {
+        auto expected{numbers};
+        for (auto& x : expected) x *= 3;
+        parallel_for_each(pool, numbers.begin(), numbers.end(), [](long& x) { x *= 3; }, grain);
+        REQUIRE(numbers == expected);
+    }
+
+    SECTION("parallel_sort") {
+        auto expected{numbers};
+        std::sort(expected.begin(), expected.end(), std::greater<>{});
+        parallel_sort(pool, numbers.begin(), numbers.end(), std::greater<>{}, grain);
+        REQUIRE(numbers == expected);
+    }
+}
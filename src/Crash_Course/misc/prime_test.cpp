@@ -0,0 +1,48 @@
+#include "prime.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <vector>
+
+std::vector<int> sieve(int max) {
+    std::vector<int> res;
+    if (max < 2) return res;
+    std::vector<bool> composite(static_cast<size_t>(max) + 1);
+    for (int64_t i{2}; i <= max; i++) {
+        if (composite[i]) continue;
+        res.push_back(static_cast<int>(i));
+        for (auto j = i * i; j <= max; j += i) composite[j] = true;
+    }
+    return res;
+}
+
+std::vector<int> collect(int max) {
+    std::vector<int> res;
+    for (const auto p : PrimeNumberRange{max}) res.push_back(p);
+    return res;
+}
+
+TEST_CASE("PrimeNumberRange") {
+    SECTION("small ranges") {
+        REQUIRE(collect(0).empty());
+        REQUIRE(collect(1).empty());
+        REQUIRE(collect(2) == std::vector{2});
+        REQUIRE(collect(3) == std::vector{2, 3});
+        REQUIRE(collect(30) == std::vector{2, 3, 5, 7, 11, 13, 17, 19, 23, 29});
+    }
+
+    SECTION("agrees with a plain sieve") {
+        for (int max = 0; max < 2'000; max++) REQUIRE(collect(max) == sieve(max));
+    }
+
+    SECTION("ranges spanning several segments") {
+        // Segment boundaries fall every 2^19 numbers
+        for (int max : {524'287, 524'288, 524'289, 1'048'579, 3'000'000}) REQUIRE(collect(max) == sieve(max));
+    }
+
+    SECTION("prime count up to 10^8") {
+        size_t count{};
+        for ([[maybe_unused]] const auto p : PrimeNumberRange{100'000'000}) count++;
+        REQUIRE(count == 5'761'455);
+    }
+}
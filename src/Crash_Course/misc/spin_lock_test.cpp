@@ -0,0 +1,84 @@
+#include "spin_lock.hpp"
+
+#include <catch2/catch_all.hpp>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+using namespace mts::concurrency;
+
+template <typename Lock>
+int hammer(Lock& lock, size_t numThreads = 8, size_t iterations = 20'000) {
+    int counter{};
+    std::vector<std::future<void>> futures;
+    for (size_t t{}; t < numThreads; t++) {
+        futures.push_back(std::async(std::launch::async, [&] {
+            for (size_t i{}; i < iterations; i++) {
+                std::lock_guard guard{lock};
+                counter++;
+            }
+        }));
+    }
+    for (auto& future : futures) future.get();
+    return counter;
+}
+
+TEMPLATE_TEST_CASE("spin locks provide mutual exclusion", "", SpinLock, TicketLock, McsLock, RwSpinLock) {
+    TestType lock;
+
+    SECTION("concurrent increments are not lost") { REQUIRE(hammer(lock) == 8 * 20'000); }
+
+    SECTION("try_lock acquires a free lock and fails on a held one") {
+        REQUIRE(lock.try_lock());
+        auto other = std::async(std::launch::async, [&] { return lock.try_lock(); });
+        REQUIRE_FALSE(other.get());
+        lock.unlock();
+
+        auto again = std::async(std::launch::async, [&] {
+            const auto res = lock.try_lock();
+            if (res) lock.unlock();
+            return res;
+        });
+        REQUIRE(again.get());
+    }
+}
+
+TEST_CASE("McsLock::ScopedLock") {
+    McsLock lock;
+    int counter{};
+    std::vector<std::future<void>> futures;
+    for (size_t t{}; t < 8; t++) {
+        futures.push_back(std::async(std::launch::async, [&] {
+            for (size_t i{}; i < 20'000; i++) {
+                McsLock::ScopedLock guard{lock};
+                counter++;
+            }
+        }));
+    }
+    for (auto& future : futures) future.get();
+    REQUIRE(counter == 8 * 20'000);
+}
+
+TEST_CASE("RwSpinLock") {
+    RwSpinLock lock;
+
+    SECTION("readers share the lock") {
+        std::shared_lock first{lock};
+        auto second = std::async(std::launch::async, [&] { return lock.try_lock_shared(); });
+        REQUIRE(second.get());
+        lock.unlock_shared();
+    }
+
+    SECTION("readers exclude writers") {
+        std::shared_lock reader{lock};
+        auto writer = std::async(std::launch::async, [&] { return lock.try_lock(); });
+        REQUIRE_FALSE(writer.get());
+    }
+
+    SECTION("writers exclude readers") {
+        std::unique_lock writer{lock};
+        auto reader = std::async(std::launch::async, [&] { return lock.try_lock_shared(); });
+        REQUIRE_FALSE(reader.get());
+    }
+}
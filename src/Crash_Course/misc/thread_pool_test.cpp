@@ -0,0 +1,76 @@
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using mts::concurrency::ThreadPool, mts::concurrency::parallel_for, mts::concurrency::WorkStealingDeque;
+
+TEST_CASE("WorkStealingDeque") {
+    WorkStealingDeque<int*> deque{2};
+    std::vector<int> values(100);
+    std::iota(values.begin(), values.end(), 0);
+
+    SECTION("owner pops in LIFO order and grows past the initial capacity") {
+        for (auto& value : values) deque.push(&value);
+        for (auto i = static_cast<int>(values.size()) - 1; i >= 0; i--) REQUIRE(*deque.pop() == i);
+        REQUIRE(deque.pop() == nullptr);
+    }
+
+    SECTION("thieves take from the top in FIFO order") {
+        for (auto& value : values) deque.push(&value);
+        REQUIRE(*deque.steal() == 0);
+        REQUIRE(*deque.steal() == 1);
+        REQUIRE(*deque.pop() == 99);
+    }
+}
+
+TEST_CASE("ThreadPool") {
+    ThreadPool pool{4};
+    REQUIRE(pool.size() == 4);
+
+    SECTION("submit returns the result through a future") {
+        auto future = pool.submit([](int a, int b) { return a + b; }, 2, 3);
+        REQUIRE(future.get() == 5);
+    }
+
+    SECTION("exceptions are propagated through the future") {
+        auto future = pool.submit([] { throw std::runtime_error("Boom"); });
+        REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+    }
+
+    SECTION("nested tasks waiting on subtasks do not deadlock") {
+        // Far more waiting parents than workers
+        std::vector<std::future<long>> parents;
+        for (long i{}; i < 64; i++) {
+            parents.push_back(pool.submit([&pool, i] {
+                std::vector<std::future<long>> children;
+                for (long j{}; j < 16; j++) children.push_back(pool.submit([i, j] { return i * j; }));
+                long sum{};
+                for (auto& child : children) sum += pool.wait(child);
+                return sum;
+            }));
+        }
+
+        long total{};
+        for (auto& parent : parents) total += pool.wait(parent);
+        // sum(i) * sum(j)
+        REQUIRE(total == (63 * 64 / 2) * (15 * 16 / 2));
+    }
+
+    SECTION("parallel_for visits every index exactly once") {
+        std::vector<std::atomic_int> hits(10'000);
+        parallel_for(pool, size_t{0}, hits.size(), [&](size_t i) { hits[i]++; });
+        REQUIRE(std::all_of(hits.begin(), hits.end(), [](const auto& h) { return h.load() == 1; }));
+    }
+
+    SECTION("parallel_for rethrows exceptions from the body") {
+        REQUIRE_THROWS_AS(parallel_for(pool, 0, 1000,
+                                       [](int i) {
+                                           if (i == 500) throw std::out_of_range("500");
+                                       }),
+                          std::out_of_range);
+    }
+}
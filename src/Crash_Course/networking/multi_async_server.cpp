@@ -10,11 +10,14 @@
 #include <string>
 #include <vector>
 
+#include "thread_pool.hpp"
+
 namespace asio = boost::asio;
 namespace sys = boost::system;
 namespace ip = asio::ip;
 using std::cout, std::endl, std::string, std::cerr, std::ostream, std::istream, std::stringstream, ip::tcp,
     boost::algorithm::to_upper;
+using mts::concurrency::ThreadPool;
 
 struct Session : std::enable_shared_from_this<Session> {
     explicit Session(tcp::socket sock) : sock{std::move(sock)} {}
@@ -53,7 +56,9 @@ void serve(tcp::acceptor& acceptor) {
 }
 
 int main() {
-    const int nThreads{3};
+    auto& pool = ThreadPool::global();
+    // Each run() occupies a pool worker for the lifetime of the server
+    const int nThreads{static_cast<int>(std::min<size_t>(3, pool.size()))};
     asio::io_context context{nThreads};
     const int port{1895};
     const auto host = tcp::v4();
@@ -61,8 +66,7 @@ int main() {
 
     serve(acceptor);
     std::vector<std::future<void>> futures;
-    std::generate_n(std::back_inserter(futures), nThreads,
-                    [&] { return std::async(std::launch::async, [&] { context.run(); }); });
+    std::generate_n(std::back_inserter(futures), nThreads, [&] { return pool.submit([&] { context.run(); }); });
     cout << "Listening on localhost:" << port << endl;
 
     for (auto& future : futures) {
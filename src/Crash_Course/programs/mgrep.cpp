@@ -4,7 +4,6 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/program_options.hpp>
-#include <condition_variable>
 #include <exception>
 #include <filesystem>
 #include <fstream>
@@ -12,22 +11,21 @@
 #include <iostream>
 #include <iterator>
 #include <map>
-#include <mutex>
 #include <regex>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "thread_pool.hpp"
+
 namespace op = boost::program_options;
 namespace fs = std::filesystem;
 namespace ba = boost::algorithm;
 
 using std::cout, std::endl, std::string, std::cerr, std::vector, std::regex, std::smatch, std::ifstream,
     std::stringstream, std::regex_search, std::string_view, std::map, std::future, std::launch, std::async;
-
-template <typename Pattern>
-using SearchFunctionType = map<fs::path, string> (*)(fs::path, Pattern, std::counting_semaphore<>&);
+using mts::concurrency::ThreadPool;
 
 struct Result {
     fs::path item;
@@ -35,36 +33,6 @@ struct Result {
     string line;
 };
 
-template <typename T>
-bool isReady(const future<T>& f) {
-    if (f.valid()) {
-        return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
-    } else {
-        return false;
-    }
-}
-
-class Semaphore {
-   public:
-    explicit Semaphore(size_t count) : count{count} {}
-    void lock() {
-        std::unique_lock<std::mutex> lock{mutex};
-        cv.wait(lock, [this] { return count != 0; });
-        count--;
-    }
-
-    void unlock() {
-        std::unique_lock<std::mutex> lock{mutex};
-        count++;
-        cv.notify_one();
-    }
-
-   private:
-    size_t count;
-    std::condition_variable cv;
-    std::mutex mutex;
-};
-
 ifstream open(const fs::path path, std::ios_base::openmode mode = std::ios_base::in) {
     ifstream file{path, mode};
     if (!file.is_open()) {
@@ -122,84 +90,51 @@ Result searchFile(fs::path item, regex pattern) {
     return {fs::path{item}, result, string{regexResults.str()}};
 }
 
-template <typename Pattern>
-map<fs::path, string> searchDir(fs::path dir, Pattern pattern, Semaphore& maxThreads) {
+// Files are searched as tasks on the pool, directory workers wait on them through the pool so nested searches
+// cannot starve it
+map<fs::path, string> collectResults(ThreadPool& pool, vector<future<Result>>& futures) {
     map<fs::path, string> paths;
-    vector<future<Result>> futures;
-    vector<Result> readyFutures;
-
-    for (const auto& item : fs::directory_iterator{dir}) {
-        futures.push_back(async(
-            launch::async,
-            [](decltype(maxThreads)& maxThreads, auto item, auto pattern) {
-                std::scoped_lock m(maxThreads);
-                return searchFile(item, pattern);
-            },
-            std::ref(maxThreads), item, pattern));
-    }
-
-    do {
-        for (auto& future : futures) {
-            if (isReady(future)) readyFutures.push_back(future.get());
-        }
-    } while (readyFutures.size() < futures.size());
-
-    for (const auto& result : readyFutures) {
+    for (auto& future : futures) {
+        const auto result = pool.wait(future);
         if (result.status) paths[result.item] = result.line;
     }
-
     return paths;
 }
 
 template <typename Pattern>
-map<fs::path, string> searchDirRecursively(fs::path dir, Pattern pattern, Semaphore& maxThreads) {
-    map<fs::path, string> paths;
+map<fs::path, string> searchDir(fs::path dir, Pattern pattern, ThreadPool& pool) {
     vector<future<Result>> futures;
-    vector<Result> readyFutures;
 
-    for (const auto& item : fs::recursive_directory_iterator{dir}) {
-        futures.push_back(async(
-            launch::async,
-            [](decltype(maxThreads)& maxThreads, auto item, auto pattern) {
-                std::scoped_lock m(maxThreads);
-                return searchFile(item, pattern);
-            },
-            std::ref(maxThreads), item, pattern));
+    for (const auto& item : fs::directory_iterator{dir}) {
+        futures.push_back(pool.submit([](fs::path item, Pattern pattern) { return searchFile(item, pattern); },
+                                      item.path(), pattern));
     }
 
-    do {
-        for (auto& future : futures) {
-            if (isReady(future)) readyFutures.push_back(future.get());
-        }
-    } while (readyFutures.size() < futures.size());
+    return collectResults(pool, futures);
+}
 
-    for (const auto& result : readyFutures) {
-        if (result.status) paths[result.item] = result.line;
+template <typename Pattern>
+map<fs::path, string> searchDirRecursively(fs::path dir, Pattern pattern, ThreadPool& pool) {
+    vector<future<Result>> futures;
+
+    for (const auto& item : fs::recursive_directory_iterator{dir}) {
+        futures.push_back(pool.submit([](fs::path item, Pattern pattern) { return searchFile(item, pattern); },
+                                      item.path(), pattern));
     }
 
-    return paths;
+    return collectResults(pool, futures);
 }
 
 template <typename Pattern>
-auto searchWorker(fs::path p, Pattern pattern, Semaphore& maxThreads) {
-    return async(
-        launch::async,
-        [](fs::path p, decltype(maxThreads)& maxThreads, auto pattern) {
-            std::scoped_lock m(maxThreads);
-            return searchDir(p, pattern, maxThreads);
-        },
-        std::move(p), std::ref(maxThreads), pattern);
+auto searchWorker(fs::path p, Pattern pattern, ThreadPool& pool) {
+    return pool.submit([&pool](fs::path p, Pattern pattern) { return searchDir(p, pattern, pool); }, std::move(p),
+                       pattern);
 }
 
 template <typename Pattern>
-auto searchRecWorker(fs::path p, Pattern pattern, Semaphore& maxThreads) {
-    return async(
-        launch::async,
-        [](fs::path p, decltype(maxThreads)& maxThreads, auto pattern) {
-            std::scoped_lock m(maxThreads);
-            return searchDirRecursively(p, pattern, maxThreads);
-        },
-        std::move(p), std::ref(maxThreads), pattern);
+auto searchRecWorker(fs::path p, Pattern pattern, ThreadPool& pool) {
+    return pool.submit([&pool](fs::path p, Pattern pattern) { return searchDirRecursively(p, pattern, pool); },
+                       std::move(p), pattern);
 }
 
 int main(int argc, char** argv) {
@@ -207,8 +142,9 @@ int main(int argc, char** argv) {
     bool isRecursive{}, isHelp{}, isRegex{};
 
     options_description desc{"mgrep [options] pattern path1 path2..."};
-    desc.add_options()("help,h", bool_switch(&isHelp), "display help")("threads,t", value<int>()->default_value(4),
-                                                                       "number of threads to use")(
+    const auto defaultThreads = static_cast<int>(ThreadPool::defaultConcurrency());
+    desc.add_options()("help,h", bool_switch(&isHelp), "display help")(
+        "threads,t", value<int>()->default_value(defaultThreads), "number of threads to use")(
         "recursive,r", bool_switch(&isRecursive), "search subddirectories recursively")(
         "regex", bool_switch(&isRegex), "parse pattern as regex")("pattern", value<string>(), "search pattern")(
         "path", value<std::vector<string>>(), "paths to search");
@@ -249,12 +185,12 @@ int main(int argc, char** argv) {
     const auto threads = vm["threads"].as<int>();
     auto& pattern = vm["pattern"].as<string>();
     const auto& path = vm["path"].as<std::vector<string>>();
-    Semaphore maxThreads{static_cast<size_t>(threads)};
 
-    if (threads < 2) {
-        std::cerr << "Threads used must be at least 2 due to a bug" << endl;
+    if (threads < 1) {
+        std::cerr << "Threads used must be at least 1" << endl;
         return -1;
     }
+    ThreadPool pool{static_cast<size_t>(threads)};
 
     regex re;
     try {
@@ -268,14 +204,13 @@ int main(int argc, char** argv) {
 
     map<fs::path, string> paths;
     vector<future<decltype(paths)>> futures;
-    vector<decltype(paths)> readyFutures;
 
     for (const auto& p : path) {
         if (!isRegex) {
             if (fs::is_directory(p) && !isRecursive) {
-                futures.push_back(searchWorker(fs::path{p}, pattern, maxThreads));
+                futures.push_back(searchWorker(fs::path{p}, pattern, pool));
             } else if (fs::is_directory(p) && isRecursive) {
-                futures.push_back(searchRecWorker(fs::path{p}, pattern, maxThreads));
+                futures.push_back(searchRecWorker(fs::path{p}, pattern, pool));
             } else if (fs::is_regular_file(p)) {
                 auto searchResults = searchFile(p, pattern);
                 if (!searchResults.status) continue;
@@ -286,9 +221,9 @@ int main(int argc, char** argv) {
             }
         } else {
             if (fs::is_directory(p) && !isRecursive) {
-                futures.push_back(searchWorker(fs::path{p}, re, maxThreads));
+                futures.push_back(searchWorker(fs::path{p}, re, pool));
             } else if (fs::is_directory(p) && isRecursive) {
-                futures.push_back(searchRecWorker(fs::path{p}, re, maxThreads));
+                futures.push_back(searchRecWorker(fs::path{p}, re, pool));
             } else if (fs::is_regular_file(p)) {
                 auto searchResults = searchFile(p, pattern);
                 if (!searchResults.status) continue;
@@ -301,13 +236,8 @@ int main(int argc, char** argv) {
     }
 
     try {
-        do {
-            for (auto& future : futures) {
-                if (isReady(future)) readyFutures.push_back(future.get());
-            }
-        } while (readyFutures.size() < futures.size());
-
-        for (const auto& results : readyFutures) {
+        for (auto& future : futures) {
+            const auto results = pool.wait(future);
             paths.insert(results.begin(), results.end());
         }
     } catch (const std::exception& e) {
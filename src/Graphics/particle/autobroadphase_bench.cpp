@@ -0,0 +1,99 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Spawner.hpp"
+#include "World.hpp"
+#include "bench_scene.hpp"
+
+// Headless benchmark of the automatic broad-phase selection
+// Runs a seeded scene that changes as it goes with every method held fixed and then with the selector picking: equal
+// particles spread evenly over the box, then a few large particles dropped in, which makes the grid's cells as wide as
+// they are, then the large particles removed again. Reports the collision time per step of every stage, the selector's
+// switches and how long each stage ran on which method.
+// Usage: autobroadphase_bench [particles] [frames per stage]
+
+using namespace std;
+
+const size_t STAGES{3};
+const size_t LARGE_PARTICLES{40};
+const int LARGE_MASS{40};
+
+struct Run {
+    array<double, STAGES> ms{};  // Collision time per step of every stage
+    array<array<size_t, COLLISION_METHOD_COUNT>, STAGES> stepsOn{};
+    vector<BroadPhaseDecision> decisions;
+};
+
+Run run(optional<CollisionDetection> method, size_t n, size_t frames) {
+    const auto box = windowBox(n);
+    World world;
+    // One generator for both stages that add particles, the large ones continue its sequence
+    Spawner spawner{42};
+    spawner.scatter(world.particles, n, {0, 0}, box, {.minMass = 1, .maxMass = 3, .maxSpeed = 40});
+    world.physics->setWinDim(0, static_cast<float>(box.x), 0, static_cast<float>(box.y));
+    world.physics->dt = 1. / 60;
+    world.physics->collisionMethod = method.value_or(CollisionDetection::UNI_SPACE_PART);
+    world.autoBroadPhase = !method;
+
+    Run result;
+    for (size_t stage{}; stage < STAGES; stage++) {
+        if (stage == 1) {
+            spawner.scatter(world.particles, LARGE_PARTICLES, {0, 0}, box,
+                            {.minMass = LARGE_MASS, .maxMass = LARGE_MASS, .maxSpeed = 40});
+        } else if (stage == 2) {
+            world.purgeParticles(n);
+        }
+
+        chrono::nanoseconds elapsed{};
+        for (size_t frame{}; frame < frames; frame++) {
+            result.stepsOn[stage][static_cast<size_t>(world.physics->collisionMethod)]++;
+            world.step();
+            elapsed += world.getPhaseTimes().broadPhase + world.getPhaseTimes().narrowPhase;
+        }
+        result.ms[stage] = chrono::duration<double, milli>(elapsed).count() / static_cast<double>(frames);
+    }
+    result.decisions = world.getBroadPhaseSelector().getDecisions();
+    return result;
+}
+
+void report(const string& name, const Run& result) {
+    double total{};
+    for (const auto ms : result.ms) total += ms;
+    cout << format("  {:<30} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} ms/step\n", name, result.ms[0], result.ms[1],
+                   result.ms[2], total / STAGES);
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? stoul(argv[1]) : 20'000;
+    const size_t frames = argc > 2 ? stoul(argv[2]) : 600;
+    cout << format("{} particles, {} frames per stage, {} large particles of mass {} in the second\n", n, frames,
+                   LARGE_PARTICLES, LARGE_MASS);
+    cout << format("  {:<30} {:>9} {:>9} {:>9} {:>9}\n", "broad and narrow phase", "even", "large", "even again",
+                   "mean");
+
+    for (size_t method{}; method < COLLISION_METHOD_COUNT; method++) {
+        const auto fixed = static_cast<CollisionDetection>(method);
+        report(parseCollisionMethods(fixed), run(fixed, n, frames));
+    }
+
+    const auto automatic = run(nullopt, n, frames);
+    report("Auto", automatic);
+    for (const auto& decision : automatic.decisions) {
+        cout << format("  step {:>5}: {} at {:.3f} ms -> {} at {:.3f} ms\n", decision.step,
+                       parseCollisionMethods(decision.from), decision.fromCost, parseCollisionMethods(decision.to),
+                       decision.toCost);
+    }
+    for (size_t stage{}; stage < STAGES; stage++) {
+        cout << format("  stage {}:", stage + 1);
+        for (size_t method{}; method < COLLISION_METHOD_COUNT; method++) {
+            if (automatic.stepsOn[stage][method] == 0) continue;
+            cout << format(" {} steps on {},", automatic.stepsOn[stage][method],
+                           parseCollisionMethods(static_cast<CollisionDetection>(method)));
+        }
+        cout << '\n';
+    }
+}
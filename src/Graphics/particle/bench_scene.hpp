@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "Spawner.hpp"
+
+// Scenes and checks shared by the headless benchmarks
+
+inline constexpr double WIDTH{1920};
+inline constexpr double HEIGHT{1080};
+inline constexpr size_t WINDOW_PARTICLES{10'000};
+
+// Box from the origin that holds n particles at the density of a full window of WINDOW_PARTICLES, widthScale times as
+// wide
+inline Vec2d windowBox(size_t n, double widthScale = 1) {
+    const auto scale = std::sqrt(static_cast<double>(n) / WINDOW_PARTICLES);
+    return {WIDTH * scale * widthScale, HEIGHT * scale};
+}
+
+struct SceneRanges {
+    double maxSpeed{50};
+    int minMass{1};
+    int maxMass{3};
+    uint64_t seed{42};
+};
+
+// Seeded particles spread uniformly over the box from min to max, flying in random directions, appended to particles
+inline void scatterScene(ParticleSystem& particles, size_t n, Vec2d min, Vec2d max, const SceneRanges& ranges = {}) {
+    Spawner spawner{ranges.seed};
+    spawner.scatter(particles, n, min, max,
+                    {.minMass = ranges.minMass, .maxMass = ranges.maxMass, .maxSpeed = ranges.maxSpeed});
+}
+
+inline ParticleSystem makeScene(size_t n, Vec2d min, Vec2d max, const SceneRanges& ranges = {}) {
+    ParticleSystem particles;
+    scatterScene(particles, n, min, max, ranges);
+    return particles;
+}
+
+// Whether both systems hold bit identical positions and velocities
+inline bool sameState(const ParticleSystem& a, const ParticleSystem& b) {
+    auto same = [](const std::vector<Real>& lhs, const std::vector<Real>& rhs) {
+        return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(Real)) == 0;
+    };
+    return same(a.x, b.x) && same(a.y, b.y) && same(a.vx, b.vx) && same(a.vy, b.vy);
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "Physics.hpp"
+#include "bench_scene.hpp"
+#include "stopwatch.hpp"
+
+// Headless benchmark of the broad-phase collision detection methods
+// Every method runs on the same seeded scene, uniform or clustered, for a number of frames with the particles jittered
+// a little between frames like a running simulation would. The world grows with the particle count so the density
+// stays that of a full window. Reports the time per frame and the number of candidate pairs, the methods that only
+// report overlapping boxes have to agree on the pair count.
+
+using namespace std;
+
+const size_t FRAMES{30};
+
+enum class Layout { UNIFORM, CLUSTERED };
+
+ParticleSystem makeLayout(size_t n, Layout layout, unsigned seed = 42) {
+    const auto box = windowBox(n);
+    if (layout == Layout::UNIFORM) return makeScene(n, {0, 0}, box, {.maxSpeed = 0, .seed = seed});
+
+    // A handful of dense blobs in an otherwise empty world
+    mt19937_64 rng{seed};
+    uniform_real_distribution<double> rngX{0, box.x};
+    uniform_real_distribution<double> rngY{0, box.y};
+    uniform_int_distribution<int> rngMass{1, 3};
+    vector<pair<double, double>> centers(8);
+    for (auto& center : centers) center = {rngX(rng), rngY(rng)};
+    uniform_int_distribution<size_t> rngCluster{0, centers.size() - 1};
+    normal_distribution<double> rngSpread{0, 80 * box.y / HEIGHT};
+
+    ParticleSystem particles;
+    particles.reserve(n);
+    for (size_t i{}; i < n; i++) {
+        const auto [cx, cy] = centers[rngCluster(rng)];
+        particles.add(cx + rngSpread(rng), cy + rngSpread(rng), 0, 0, rngMass(rng));
+    }
+    return particles;
+}
+
+void jitter(ParticleSystem& particles, mt19937_64& rng) {
+    uniform_real_distribution<double> rngStep{-0.5, 0.5};
+    for (size_t i{}; i < particles.size(); i++) {
+        particles.x[i] += rngStep(rng);
+        particles.y[i] += rngStep(rng);
+    }
+}
+
+int main() {
+    const vector<CollisionDetection> methods{
+        CollisionDetection::SWEEP_AND_PRUNE,
+        CollisionDetection::SWEEP_AND_PRUNE_DUAL_AXIS,
+        CollisionDetection::UNI_SPACE_PART,
+        CollisionDetection::KD_TREE,
+        CollisionDetection::BVH_TREE,
+    };
+
+    for (const auto layout : {Layout::UNIFORM, Layout::CLUSTERED}) {
+        for (const size_t n : {10'000, 100'000}) {
+            cout << format("{} scene, {} particles\n", layout == Layout::UNIFORM ? "Uniform" : "Clustered", n);
+
+            size_t exactPairs{};
+            for (const auto method : methods) {
+                auto particles = makeLayout(n, layout);
+                SimplePhysics physics{1. / 60, particles};
+                physics.collisionMethod = method;
+                mt19937_64 rng{7};
+
+                chrono::nanoseconds elapsed{};
+                size_t pairs{};
+                for (size_t frame{}; frame < FRAMES; frame++) {
+                    jitter(particles, rng);
+                    chrono::nanoseconds frameTime{};
+                    {
+                        Stopwatch stopwatch{frameTime};
+                        physics.findCandidatePairs();
+                    }
+                    elapsed += frameTime;
+                    pairs = physics.candidatePairs().size();
+                }
+
+                // Single axis sweep and prune and the grid also report pairs that are only close, the rest report
+                // exactly the pairs whose boxes overlap
+                string_view note;
+                if (method != CollisionDetection::SWEEP_AND_PRUNE && method != CollisionDetection::UNI_SPACE_PART) {
+                    if (exactPairs == 0) exactPairs = pairs;
+                    if (pairs != exactPairs) note = "MISMATCH";
+                }
+
+                const auto ms = chrono::duration<double, milli>(elapsed).count() / FRAMES;
+                cout << format("  {:<30} {:>9.3f} ms/frame {:>9} pairs {}\n", parseCollisionMethods(method), ms, pairs,
+                               note);
+            }
+            cout << '\n';
+        }
+    }
+}
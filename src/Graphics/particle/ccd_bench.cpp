@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+#include "bench_scene.hpp"
+
+// Headless benchmark of continuous collision detection
+// Fires a seeded spray of small fast particles at a barrier across the middle of the box, two columns of touching
+// particles too heavy to be moved, and runs the same simulated time at growing step sizes, once with continuous
+// collision detection off and once with it on. Reports how many bullets ended up past the barrier, how many left the
+// box and were culled, and the CPU time per simulated second. No bullet fits through the barrier, without continuous
+// collision detection they start going through it and the walls once a step carries them further than the barrier
+// is thick. The narrow phase pushes touching particles apart by the same distance whatever their masses, the barrier
+// is put back after every step so that a bullet can only get past it by tunnelling.
+// Usage: ccd_bench [bullets] [bullet speed] [simulated seconds]
+
+using namespace std;
+
+const int BARRIER_MASS{3};
+const int BULLET_MASS{1};
+const double BARRIER_WEIGHT{1e9};  // Mass the barrier particles are given once their radius is set
+
+struct Pinned {
+    ParticleHandle handle;
+    double x;
+    double y;
+};
+
+struct Result {
+    size_t passed{};
+    size_t escaped{};
+    size_t sweptHits{};
+    double msPerSecond{};
+};
+
+Result run(size_t bullets, double speed, double seconds, double dt, bool continuous) {
+    World world;
+    auto& particles = world.particles;
+    world.physics->setWinDim(0, static_cast<float>(WIDTH), 0, static_cast<float>(HEIGHT));
+    world.physics->dt = dt;
+    world.physics->continuous = continuous;
+    world.cull = true;
+
+    // Touching columns of resting particles
+    const auto barrierRadius = 2. * BARRIER_MASS;
+    const auto barrierX = WIDTH / 2;
+    vector<Pinned> barrier;
+    for (const auto column : {0, 1}) {
+        for (auto y = barrierRadius; y < HEIGHT; y += 2 * barrierRadius) {
+            const auto x = barrierX + column * 2 * barrierRadius;
+            const auto handle = particles.add(x, y, 0, 0, BARRIER_MASS);
+            particles.mass[particles.indexOf(handle)] = BARRIER_WEIGHT;
+            barrier.push_back({handle, x, y});
+        }
+    }
+    const auto barrierEnd = barrierX + 3 * barrierRadius;
+    const auto barrierCount = particles.size();
+
+    mt19937_64 rng{42};
+    uniform_real_distribution<double> rngX{WIDTH / 8, barrierX - 4 * barrierRadius};
+    uniform_real_distribution<double> rngY{barrierRadius, HEIGHT - barrierRadius};
+    uniform_real_distribution<double> rngAngle{-0.3, 0.3};
+    for (size_t i{}; i < bullets; i++) {
+        const auto angle = rngAngle(rng);
+        particles.add(rngX(rng), rngY(rng), speed * cos(angle), speed * sin(angle), BULLET_MASS);
+    }
+
+    Result result;
+    const auto steps = static_cast<size_t>(round(seconds / dt));
+    chrono::nanoseconds elapsed{};
+    for (size_t step{}; step < steps; step++) {
+        world.step();
+        elapsed += world.getPhaseTimes().total();
+        for (const auto& pinned : barrier) {
+            const auto i = particles.indexOf(pinned.handle);
+            particles.x[i] = pinned.x;
+            particles.y[i] = pinned.y;
+            particles.vx[i] = particles.vy[i] = 0;
+        }
+        result.sweptHits += world.physics->collisionStats.sweptHits;
+    }
+
+    for (size_t i{}; i < particles.size(); i++) {
+        if (particles.mass[i] == BULLET_MASS && particles.x[i] > barrierEnd) result.passed++;
+    }
+    result.escaped = barrierCount + bullets - particles.size();
+    result.msPerSecond = chrono::duration<double, milli>(elapsed).count() / seconds;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const size_t bullets = argc > 1 ? stoul(argv[1]) : 2000;
+    const double speed = argc > 2 ? stod(argv[2]) : 1500;
+    const double seconds = argc > 3 ? stod(argv[3]) : 1;
+    cout << format("{} bullets at {} px/s, {} simulated seconds, barrier {} px thick\n", bullets, speed, seconds,
+                   8 * BARRIER_MASS);
+
+    for (const auto rate : {240, 120, 60, 30, 15}) {
+        const auto dt = 1. / rate;
+        cout << format("dt 1/{:<4} {:>5.1f} px per step\n", rate, speed * dt);
+        for (const auto continuous : {false, true}) {
+            const auto result = run(bullets, speed, seconds, dt, continuous);
+            cout << format("  {:<10} {:>6} past the barrier {:>6} culled {:>8} swept contacts {:>9.2f} ms per "
+                           "simulated second\n",
+                           continuous ? "continuous" : "discrete", result.passed, result.escaped, result.sweptHits,
+                           result.msPerSecond);
+        }
+    }
+}
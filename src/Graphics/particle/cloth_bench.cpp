@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+
+// Headless benchmark of the distance constraint solver
+// Hangs a sheet of cloth, a grid of particles tied to their right and lower neighbours, from its pinned top row at a
+// few timesteps from small to large and reports the constraint solve time per step and how far the springs are from
+// their rest length at the end. The window leaves room below for the cloth to stretch to three times its length
+// without reaching the floor, so only the solver holds it up. A solver that is not stable at a timestep ends with a
+// large or non finite strain.
+// Usage: cloth_bench [columns] [rows] [iterations] [threads]
+
+using namespace std;
+
+const double SPACING{5};
+const double SIMULATED_SECONDS{4};
+const double GRAVITY{100};
+
+struct Pinned {
+    ParticleHandle handle;
+    double x;
+    double y;
+};
+
+struct Result {
+    double constraintNs;
+    double totalNs;
+    double meanStrain;
+    double maxStrain;
+    size_t colors;
+};
+
+Result run(size_t cols, size_t rows, size_t iterations, size_t threads, double dt) {
+    World world;
+    const auto width = static_cast<double>(cols) * SPACING * 2;
+    const auto height = static_cast<double>(rows) * SPACING * 3;
+    world.physics->setWinDim(0, static_cast<float>(width), 0, static_cast<float>(height));
+    world.physics->dt = dt;
+    world.physics->gravity = {0, GRAVITY};
+    world.physics->parallel = threads > 1;
+    world.physics->parallelStep.setThreads(threads);
+    world.springs.setIterations(iterations);
+
+    vector<ParticleHandle> grid(cols * rows);
+    vector<Pinned> top;
+    const auto left = width / 4;
+    for (size_t row{}; row < rows; row++) {
+        for (size_t col{}; col < cols; col++) {
+            const auto x = left + static_cast<double>(col) * SPACING;
+            const auto y = SPACING + static_cast<double>(row) * SPACING;
+            grid[row * cols + col] = world.particles.add(x, y, 0, 0, 1);
+            if (row == 0) top.push_back({grid[col], x, y});
+        }
+    }
+    for (size_t row{}; row < rows; row++) {
+        for (size_t col{}; col < cols; col++) {
+            const auto here = grid[row * cols + col];
+            if (col + 1 < cols) world.addSpring(here, grid[row * cols + col + 1], SPACING, 0);
+            if (row + 1 < rows) world.addSpring(here, grid[(row + 1) * cols + col], SPACING, 0);
+        }
+    }
+
+    const auto steps = static_cast<size_t>(SIMULATED_SECONDS / dt);
+    chrono::nanoseconds constraints{};
+    chrono::nanoseconds total{};
+    for (size_t s{}; s < steps; s++) {
+        world.step();
+        constraints += world.getPhaseTimes().constraints;
+        total += world.getPhaseTimes().total();
+        auto& particles = world.particles;
+        for (const auto& pinned : top) {
+            const auto i = particles.indexOf(pinned.handle);
+            particles.x[i] = pinned.x;
+            particles.y[i] = pinned.y;
+            particles.vx[i] = particles.vy[i] = 0;
+        }
+    }
+
+    double sumStrain{};
+    double maxStrain{};
+    for (size_t k{}; k < world.springs.size(); k++) {
+        const auto strain = abs(world.springs.getLength(k) - world.springs.getRestLength(k)) / SPACING;
+        sumStrain += strain;
+        maxStrain = isfinite(strain) ? max(maxStrain, strain) : INFINITY;
+    }
+    return {static_cast<double>(constraints.count()) / static_cast<double>(steps),
+            static_cast<double>(total.count()) / static_cast<double>(steps),
+            sumStrain / static_cast<double>(world.springs.size()), maxStrain, world.springs.getColorCount()};
+}
+
+int main(int argc, char** argv) {
+    const size_t cols = argc > 1 ? stoul(argv[1]) : 200;
+    const size_t rows = argc > 2 ? stoul(argv[2]) : 100;
+    const size_t iterations = argc > 3 ? stoul(argv[3]) : DistanceConstraints::DEFAULT_ITERATIONS;
+    const size_t threads = argc > 4 ? stoul(argv[4]) : 1;
+
+    cout << format("{}x{} cloth, {} iterations, {} threads, {} simulated seconds\n", cols, rows, iterations, threads,
+                   SIMULATED_SECONDS);
+    for (const auto stepsPerSecond : {240, 60, 15}) {
+        const auto [constraintNs, totalNs, meanStrain, maxStrain, colors] =
+            run(cols, rows, iterations, threads, 1. / stepsPerSecond);
+        cout << format("dt 1/{:<4} {:>10.0f} ns/step constraints {:>10.0f} ns/step total {} colors, strain mean "
+                       "{:.4f} max {:.3f}\n",
+                       stepsPerSecond, constraintNs, totalNs, colors, meanStrain, maxStrain);
+    }
+}
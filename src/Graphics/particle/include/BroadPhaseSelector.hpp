@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "Physics.hpp"
+
+// One switch of the broad-phase made by BroadPhaseSelector
+struct BroadPhaseDecision {
+    size_t step;  // Steps the selector had seen
+    CollisionDetection from;
+    CollisionDetection to;
+    double fromCost;  // Milliseconds per step of both collision phases, as probed
+    double toCost;
+};
+
+// Picks the broad-phase method from how every method does on the running scene
+// The cost of a method is the time of the broad and the narrow phase of a step together, a method that finds fewer
+// candidate pairs pays for its tighter test in the broad phase and gets it back in the narrow one. The selector runs
+// one method and every so often probes all of them for a few steps each, the current one first. Every other method
+// gets a warm-up step, its structures carry over from step to step, and is dropped early once it falls far behind.
+// The fastest of the measured steps is a method's cost.
+//
+// It only switches to a method that beats the current one by SWITCH_MARGIN and by MIN_GAIN, a probe that changes
+// nothing doubles the time to the next one. The current method's cost or its candidate pair count moving away from
+// what the last probe measured, the scene spreading out or clumping together, probes again early.
+class BroadPhaseSelector {
+   public:
+    // Results of the last probe of a method
+    struct Probe {
+        double cost{};  // Milliseconds per step
+        size_t pairs{};
+        bool measured{};
+    };
+
+    static constexpr size_t PROBE_STEPS{3};     // Measured steps of every method in a probe
+    static constexpr double SWITCH_MARGIN{0.15};
+    static constexpr double MIN_GAIN{0.05};     // Milliseconds per step
+    static constexpr size_t MAX_DECISIONS{32};  // Most recent decisions kept
+
+    // Called after every step with the method it ran, its collision time and its candidate pairs, returns the method
+    // for the next step. A method other than the one handed out last, picked by hand in between, starts over from it.
+    CollisionDetection observe(CollisionDetection used, std::chrono::nanoseconds elapsed, size_t pairs) {
+        steps++;
+        const auto ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        if (!started || used != next) restart(used);
+        if (probing) return probe(used, ms, pairs);
+
+        average = average == 0 ? ms : average + SMOOTHING * (ms - average);
+        averagePairs += SMOOTHING * (static_cast<double>(pairs) - averagePairs);
+        sinceProbe++;
+        const auto drifted = sinceProbe >= MIN_PROBE_SPACING && (movedAway(average, reference, DRIFT) ||
+                                                                 movedAway(averagePairs, referencePairs, PAIR_DRIFT));
+        if (sinceProbe >= interval || drifted) startProbe();
+        return next;
+    }
+
+    // Starts over on the method, probing once the next few steps have run
+    void restart(CollisionDetection method) {
+        started = true;
+        current = next = method;
+        probing = false;
+        average = reference = 0;
+        averagePairs = referencePairs = 0;
+        sinceProbe = 0;
+        interval = MIN_PROBE_SPACING;
+        probes = {};
+    }
+
+    [[nodiscard]] CollisionDetection getCurrent() const { return current; }
+    [[nodiscard]] bool isProbing() const { return probing; }
+    // Smoothed cost of the current method, milliseconds per step
+    [[nodiscard]] double getAverageCost() const { return average; }
+    [[nodiscard]] const std::array<Probe, COLLISION_METHOD_COUNT>& getProbes() const { return probes; }
+    // Most recent switches oldest first, up to MAX_DECISIONS
+    [[nodiscard]] const std::vector<BroadPhaseDecision>& getDecisions() const { return decisions; }
+    // Switches made since construction, keeps counting past MAX_DECISIONS
+    [[nodiscard]] size_t getDecisionCount() const { return decisionCount; }
+
+   private:
+    static constexpr size_t PROBE_INTERVAL{240};  // Steps between probes after a switch
+    static constexpr size_t MAX_PROBE_INTERVAL{3840};
+    static constexpr size_t MIN_PROBE_SPACING{60};
+    static constexpr double SMOOTHING{0.05};
+    // Ratios between the current cost and the probed one and between the pair counts that probe again, a method's
+    // cost can stay level while the scene changes under it but the pairs it finds do not
+    static constexpr double DRIFT{1.5};
+    static constexpr double PAIR_DRIFT{1.25};
+    static constexpr double ABANDON{2.0};  // Ratio to the current method's cost past which a probed method is dropped
+
+    static size_t slot(CollisionDetection method) { return static_cast<size_t>(method); }
+
+    static bool movedAway(double value, double reference, double ratio) {
+        return reference > 0 && (value > reference * ratio || value * ratio < reference);
+    }
+
+    // First method from index on that is not the current one, COLLISION_METHOD_COUNT once none is left
+    [[nodiscard]] size_t nextCandidate(size_t index) const {
+        while (index < COLLISION_METHOD_COUNT && index == slot(current)) index++;
+        return index;
+    }
+
+    void startProbe() {
+        probing = true;
+        probes = {};
+        probeStep = 0;
+        next = current;
+    }
+
+    CollisionDetection probe(CollisionDetection used, double ms, size_t pairs) {
+        auto& result = probes[slot(used)];
+        const auto warmUp = used != current && probeStep == 0;
+        const auto firstMeasured = probeStep == (used == current ? 0 : 1);
+        // The warm-up step stands in until a measured one replaces it, in case the method is dropped after it
+        result.cost = warmUp || firstMeasured ? ms : std::min(result.cost, ms);
+        result.pairs = pairs;
+        result.measured = true;
+        probeStep++;
+
+        // Building a structure from scratch in the warm-up step is allowed to take longer
+        const auto stepsOfMethod = used == current ? PROBE_STEPS : PROBE_STEPS + 1;
+        const auto limit = (warmUp ? 2 : 1) * ABANDON * probes[slot(current)].cost;
+        if (probeStep < stepsOfMethod && (used == current || ms <= limit)) return next;
+
+        probeStep = 0;
+        const auto following = nextCandidate(used == current ? 0 : slot(used) + 1);
+        if (following == COLLISION_METHOD_COUNT)
+            finishProbe();
+        else
+            next = static_cast<CollisionDetection>(following);
+        return next;
+    }
+
+    void finishProbe() {
+        probing = false;
+        auto best = current;
+        for (size_t method{}; method < COLLISION_METHOD_COUNT; method++) {
+            if (probes[method].measured && probes[method].cost < probes[slot(best)].cost)
+                best = static_cast<CollisionDetection>(method);
+        }
+
+        const auto currentCost = probes[slot(current)].cost;
+        const auto bestCost = probes[slot(best)].cost;
+        if (best != current && bestCost < currentCost * (1 - SWITCH_MARGIN) && currentCost - bestCost > MIN_GAIN) {
+            if (decisions.size() == MAX_DECISIONS) decisions.erase(decisions.begin());
+            decisions.push_back({steps, current, best, currentCost, bestCost});
+            decisionCount++;
+            current = best;
+            interval = PROBE_INTERVAL;
+        } else {
+            interval = std::min(std::max(interval, PROBE_INTERVAL / 2) * 2, MAX_PROBE_INTERVAL);
+        }
+        next = current;
+        reference = average = probes[slot(current)].cost;
+        referencePairs = averagePairs = static_cast<double>(probes[slot(current)].pairs);
+        sinceProbe = 0;
+    }
+
+    CollisionDetection current{};
+    CollisionDetection next{};  // Method handed out for the next step
+    bool started{};
+    bool probing{};
+    double average{};    // Smoothed cost of the current method
+    double reference{};  // Cost of the current method in the last probe
+    double averagePairs{};
+    double referencePairs{};
+    size_t steps{};
+    size_t sinceProbe{};
+    size_t interval{MIN_PROBE_SPACING};  // Steps from the last probe to the next
+    size_t probeStep{};                  // Steps run of the method under probe
+    std::array<Probe, COLLISION_METHOD_COUNT> probes{};
+    std::vector<BroadPhaseDecision> decisions;
+    size_t decisionCount{};
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "aliases.hpp"
+
+// Bounding volume hierarchy broad-phase over particle AABBs
+// Nodes live in one array in depth first order: an inner node's left child directly follows it and right holds the
+// index of its right child, a leaf points at a run of particle indices in items. Particles move a little every frame
+// so the boxes are refit bottom up each frame and the whole tree is only rebuilt every few frames or when particles
+// were added or removed.
+class Bvh {
+   public:
+    struct Aabb {
+        Real minX;
+        Real minY;
+        Real maxX;
+        Real maxY;
+
+        [[nodiscard]] bool overlaps(const Aabb& other) const {
+            return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+        }
+
+        void expand(const Aabb& other) {
+            minX = std::min(minX, other.minX);
+            minY = std::min(minY, other.minY);
+            maxX = std::max(maxX, other.maxX);
+            maxY = std::max(maxY, other.maxY);
+        }
+    };
+
+    void update(const ParticleSystem& particles) {
+        if (particles.size() != items.size() || framesSinceBuild >= REBUILD_INTERVAL) {
+            build(particles);
+        } else {
+            refit(particles);
+            framesSinceBuild++;
+        }
+    }
+
+    void build(const ParticleSystem& particles) {
+        const auto n = particles.size();
+        items.resize(n);
+        leafBoxes.resize(n);
+        for (size_t i{}; i < n; i++) items[i] = static_cast<uint32_t>(i);
+        nodes.clear();
+        framesSinceBuild = 0;
+        if (n > 0) buildNode(particles, 0, n);
+    }
+
+    // Every pair of particles whose boxes overlap, each pair once with a < b
+    void findPairs(const ParticleSystem& particles, PairList& pairs) const {
+        pairs.clear();
+        if (nodes.empty()) return;
+        for (uint32_t i{}; i < particles.size(); i++) {
+            const Aabb box{particles.x[i] - particles.radius[i], particles.y[i] - particles.radius[i],
+                           particles.x[i] + particles.radius[i], particles.y[i] + particles.radius[i]};
+            query(box, [&](uint32_t j) {
+                if (j > i) pairs.push_back({i, j});
+            });
+        }
+    }
+
+    // Calls fn(index) for every particle whose box overlaps box
+    template <typename Fn>
+    void query(const Aabb& box, Fn&& fn) const {
+        if (nodes.empty()) return;
+        std::array<uint32_t, MAX_DEPTH> stack;
+        size_t top{};
+        stack[top++] = 0;
+        while (top > 0) {
+            const auto index = stack[--top];
+            const auto& node = nodes[index];
+            if (!node.box.overlaps(box)) continue;
+            if (node.count > 0) {
+                for (auto k = node.first; k < node.first + node.count; k++) {
+                    if (leafBoxes[k].overlaps(box)) fn(items[k]);
+                }
+            } else {
+                stack[top++] = node.right;
+                stack[top++] = index + 1;
+            }
+        }
+    }
+
+    [[nodiscard]] size_t nodeCount() const { return nodes.size(); }
+
+   private:
+    struct Node {
+        Aabb box;
+        uint32_t first;  // Leaf: first item
+        uint32_t count;  // Leaf: number of items, 0 for inner nodes
+        uint32_t right;  // Inner: index of the right child
+    };
+
+    static constexpr size_t LEAF_SIZE{4};
+    static constexpr size_t REBUILD_INTERVAL{30};
+    // Median splits keep the tree balanced, 2^64 leaves is plenty
+    static constexpr size_t MAX_DEPTH{128};
+    static constexpr Aabb EMPTY{std::numeric_limits<Real>::max(), std::numeric_limits<Real>::max(),
+                                std::numeric_limits<Real>::lowest(), std::numeric_limits<Real>::lowest()};
+
+    static Aabb boxOf(const ParticleSystem& particles, uint32_t i) {
+        return {particles.x[i] - particles.radius[i], particles.y[i] - particles.radius[i],
+                particles.x[i] + particles.radius[i], particles.y[i] + particles.radius[i]};
+    }
+
+    uint32_t buildNode(const ParticleSystem& particles, size_t first, size_t last) {
+        const auto index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({EMPTY, static_cast<uint32_t>(first), 0, 0});
+
+        Aabb centers{EMPTY};
+        for (auto k = first; k < last; k++) {
+            const auto i = items[k];
+            nodes[index].box.expand(boxOf(particles, i));
+            centers.expand({particles.x[i], particles.y[i], particles.x[i], particles.y[i]});
+        }
+
+        if (last - first <= LEAF_SIZE) {
+            nodes[index].count = static_cast<uint32_t>(last - first);
+            for (auto k = first; k < last; k++) leafBoxes[k] = boxOf(particles, items[k]);
+            return index;
+        }
+
+        // Median split along the wider extent of the particle centers
+        const auto& axis = centers.maxX - centers.minX >= centers.maxY - centers.minY ? particles.x : particles.y;
+        const auto mid = first + (last - first) / 2;
+        std::nth_element(items.begin() + first, items.begin() + mid, items.begin() + last,
+                         [&axis](uint32_t a, uint32_t b) { return axis[a] < axis[b]; });
+
+        buildNode(particles, first, mid);
+        const auto right = buildNode(particles, mid, last);
+        nodes[index].right = right;
+        return index;
+    }
+
+    // Children always come after their parent so a reverse sweep refits every child before its parent
+    void refit(const ParticleSystem& particles) {
+        for (auto index = nodes.size(); index-- > 0;) {
+            auto& node = nodes[index];
+            if (node.count > 0) {
+                node.box = EMPTY;
+                for (auto k = node.first; k < node.first + node.count; k++) {
+                    leafBoxes[k] = boxOf(particles, items[k]);
+                    node.box.expand(leafBoxes[k]);
+                }
+            } else {
+                node.box = nodes[index + 1].box;
+                node.box.expand(nodes[node.right].box);
+            }
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> items;  // Particle indices, every leaf owns a contiguous run
+    std::vector<Aabb> leafBoxes;  // Box of items[k], kept next to the run so leaf tests stay in cache
+    size_t framesSinceBuild{};
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "aliases.hpp"
+#include "multithreading.hpp"
+
+// Springs between pairs of particles, solved as XPBD distance constraints
+// Each step the solver moves the particles directly to bring every constraint back towards its rest length, weighted
+// by inverse mass, and adds the same correction over dt to their velocities, which is what deriving the velocity
+// from the change in position as Verlet does would give. Compliance is the inverse of stiffness: zero gives a rigid
+// rod and larger values a softer spring that behaves the same at any timestep, unlike a Hooke force with explicit
+// Euler which blows up once the step gets too large for the stiffness.
+//
+// The constraints live in contiguous arrays kept sorted by an edge coloring of the particle graph, no two constraints
+// of a color share a particle so each color is projected in parallel. The coloring is redone only when constraints
+// are added or removed.
+class DistanceConstraints {
+   public:
+    static constexpr double DEFAULT_COMPLIANCE{1.0 / 100};  // Same stiffness as the old Hooke springs, K = 100
+    static constexpr size_t DEFAULT_ITERATIONS{4};
+
+    void add(ParticleHandle first, ParticleHandle second, double restLength, double compliance = DEFAULT_COMPLIANCE) {
+        if (first.isNull() || second.isNull() || first.id == second.id) return;
+        this->first.push_back(first);
+        this->second.push_back(second);
+        this->restLength.push_back(restLength);
+        this->compliance.push_back(std::max(compliance, 0.0));
+        length.push_back(restLength);
+        dirty = true;
+    }
+
+    // Drops constraints attached to a particle that no longer exists
+    void removeInvalid(const ParticleSystem& particles) {
+        size_t write{};
+        for (size_t k{}; k < size(); k++) {
+            if (!particles.contains(first[k]) || !particles.contains(second[k])) continue;
+            first[write] = first[k];
+            second[write] = second[k];
+            restLength[write] = restLength[k];
+            compliance[write] = compliance[k];
+            length[write] = length[k];
+            write++;
+        }
+        if (write == size()) return;
+        resize(write);
+        dirty = true;
+    }
+
+    void clear() {
+        resize(0);
+        dirty = true;
+    }
+
+    // Projects every constraint iterations times, dt is the step the particles were just integrated over
+    void solve(ParticleSystem& particles, double dt, ParallelStep& parallelStep) {
+        if (empty() || dt <= 0) return;
+        if (dirty) sortByColor();
+
+        // Slots move when particles are removed, resolve them once per step instead of once per projection
+        for (size_t k{}; k < size(); k++) {
+            const auto a = particles.indexOf(first[k]);
+            const auto b = particles.indexOf(second[k]);
+            slots[k] = a == ParticleSystem::NPOS || b == ParticleSystem::NPOS
+                           ? CandidatePair{INVALID_SLOT, INVALID_SLOT}
+                           : CandidatePair{static_cast<uint32_t>(a), static_cast<uint32_t>(b)};
+        }
+        std::ranges::fill(lambda, 0);
+
+        const auto invDt = static_cast<Real>(1 / dt);
+        const auto invDtSq = invDt * invDt;
+        for (size_t iteration{}; iteration < iterations; iteration++) {
+            parallelStep.forEachColor(coloring, [&](size_t begin, size_t end) {
+                for (auto k = begin; k < end; k++) project(particles, k, invDt, invDtSq);
+            });
+        }
+    }
+
+    void setIterations(size_t iterations) { this->iterations = std::max<size_t>(iterations, 1); }
+    [[nodiscard]] size_t getIterations() const { return iterations; }
+    // Colors of the current constraint graph, including the overflow bucket when it was needed
+    [[nodiscard]] size_t getColorCount() const { return coloring.getColorCount(); }
+
+    [[nodiscard]] size_t size() const { return first.size(); }
+    [[nodiscard]] bool empty() const { return first.empty(); }
+    // Constraints are reordered when the set changes, indices are only stable between adds and removals
+    [[nodiscard]] ParticleHandle getFirst(size_t k) const { return first[k]; }
+    [[nodiscard]] ParticleHandle getSecond(size_t k) const { return second[k]; }
+    [[nodiscard]] double getRestLength(size_t k) const { return restLength[k]; }
+    // Length as of the last solve
+    [[nodiscard]] double getLength(size_t k) const { return length[k]; }
+
+   private:
+    static constexpr uint32_t INVALID_SLOT{ParticleHandle::INVALID};
+    static constexpr Real EPSILON{1e-9};
+
+    void project(ParticleSystem& particles, size_t k, Real invDt, Real invDtSq) {
+        const auto [a, b] = slots[k];
+        if (a == INVALID_SLOT || (particles.isAsleep(a) && particles.isAsleep(b))) return;
+
+        const auto dx = particles.x[a] - particles.x[b];
+        const auto dy = particles.y[a] - particles.y[b];
+        const auto dist = std::sqrt(dx * dx + dy * dy);
+        length[k] = dist;
+        // Coincident particles give no direction to push along
+        if (dist < EPSILON) return;
+
+        const auto wA = 1 / particles.mass[a];
+        const auto wB = 1 / particles.mass[b];
+        const auto alpha = compliance[k] * invDtSq;
+        const auto denom = wA + wB + alpha;
+        if (denom <= 0) return;
+
+        const auto error = dist - restLength[k];
+        const auto deltaLambda = (-error - alpha * lambda[k]) / denom;
+        lambda[k] += deltaLambda;
+
+        const auto scale = deltaLambda / dist;
+        const auto px = scale * dx;
+        const auto py = scale * dy;
+        particles.x[a] += wA * px;
+        particles.y[a] += wA * py;
+        particles.x[b] -= wB * px;
+        particles.y[b] -= wB * py;
+        particles.vx[a] += wA * px * invDt;
+        particles.vy[a] += wA * py * invDt;
+        particles.vx[b] -= wB * px * invDt;
+        particles.vy[b] -= wB * py * invDt;
+    }
+
+    // Colors the constraints by the handle ids of their particles, which do not change while both ends exist, and
+    // moves them into color order
+    void sortByColor() {
+        PairList ends(size());
+        uint32_t idBound{};
+        for (size_t k{}; k < size(); k++) {
+            ends[k] = {first[k].id, second[k].id};
+            idBound = std::max({idBound, first[k].id + 1, second[k].id + 1});
+        }
+        coloring.color(ends, idBound);
+
+        const auto& order = coloring.getOrder();
+        permute(first, order);
+        permute(second, order);
+        permute(restLength, order);
+        permute(compliance, order);
+        permute(length, order);
+        slots.resize(size());
+        lambda.resize(size());
+        dirty = false;
+    }
+
+    template <typename T>
+    static void permute(std::vector<T>& values, const std::vector<size_t>& order) {
+        std::vector<T> sorted(values.size());
+        for (size_t k{}; k < order.size(); k++) sorted[k] = values[order[k]];
+        values = std::move(sorted);
+    }
+
+    void resize(size_t n) {
+        first.resize(n);
+        second.resize(n);
+        restLength.resize(n);
+        compliance.resize(n);
+        length.resize(n);
+    }
+
+    std::vector<ParticleHandle> first;
+    std::vector<ParticleHandle> second;
+    std::vector<Real> restLength;
+    std::vector<Real> compliance;
+    std::vector<Real> length;
+    std::vector<Real> lambda;  // Accumulated multiplier of each constraint over the iterations of a step
+    PairList slots;              // Particle slots of each constraint for the current step
+    EdgeColoring coloring;
+    size_t iterations{DEFAULT_ITERATIONS};
+    bool dirty{false};
+};
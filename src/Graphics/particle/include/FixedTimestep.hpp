@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+// Fixed timestep accumulator
+// Real time goes in each frame and a whole number of fixed steps comes out, the remainder carries over to the next
+// frame and tells the renderer how far to interpolate between the last two states. Steps per frame are capped so a
+// slow frame cannot queue up more work than the next frame can do, the time past the cap is dropped and the
+// simulation runs slower than real time instead of spiralling.
+class FixedTimestep {
+   public:
+    FixedTimestep(double step, size_t maxSteps) : step{step}, maxSteps{std::max<size_t>(maxSteps, 1)} {}
+
+    // Adds elapsed seconds, returns how many steps to run this frame
+    size_t advance(double elapsed) {
+        accumulator = std::min(accumulator + elapsed, step * static_cast<double>(maxSteps));
+        const auto steps = std::min(static_cast<size_t>(accumulator / step), maxSteps);
+        accumulator -= step * static_cast<double>(steps);
+        lastSteps = steps;
+        return steps;
+    }
+
+    // Fraction of a step left in the accumulator, between 0 and 1
+    [[nodiscard]] double alpha() const { return std::clamp(accumulator / step, 0.0, 1.0); }
+
+    void setStep(double step) {
+        this->step = step;
+        accumulator = std::min(accumulator, step);
+    }
+    void setMaxSteps(size_t maxSteps) { this->maxSteps = std::max<size_t>(maxSteps, 1); }
+
+    [[nodiscard]] double getStep() const { return step; }
+    [[nodiscard]] size_t getMaxSteps() const { return maxSteps; }
+    [[nodiscard]] size_t getLastSteps() const { return lastSteps; }
+
+   private:
+    double step;
+    size_t maxSteps;
+    double accumulator{};
+    size_t lastSteps{};
+};
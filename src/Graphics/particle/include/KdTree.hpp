@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "aliases.hpp"
+
+// 2D tree over particle centers
+// The tree is implicit: the points of a subtree occupy a range of the points array, the median of the range is the
+// node and the halves either side of it are its children. Each point records the axis its subtree was split on.
+// Building is a copy and a few nth_element passes so the tree is rebuilt from scratch every frame.
+class KdTree {
+   public:
+    void build(const ParticleSystem& particles) {
+        const auto n = particles.size();
+        points.resize(n);
+        maxRadius = 0;
+        for (size_t i{}; i < n; i++) {
+            points[i] = {particles.x[i], particles.y[i], particles.radius[i], static_cast<uint32_t>(i), 0};
+            maxRadius = std::max(maxRadius, particles.radius[i]);
+        }
+        buildTree();
+    }
+
+    // Calls fn(index) for every particle whose center is within radius of (x, y)
+    template <typename Fn>
+    void radiusQuery(double x, double y, double radius, Fn&& fn) const {
+        const auto radiusSq = radius * radius;
+        std::array<std::pair<uint32_t, uint32_t>, MAX_DEPTH> stack;
+        size_t top{};
+        if (!points.empty()) stack[top++] = {0, static_cast<uint32_t>(points.size())};
+
+        while (top > 0) {
+            const auto [first, last] = stack[--top];
+            const auto mid = first + (last - first) / 2;
+            const auto& p = points[mid];
+
+            const auto dx = p.x - x;
+            const auto dy = p.y - y;
+            if (dx * dx + dy * dy <= radiusSq) fn(p.id);
+
+            const auto d = p.axis == 0 ? x - p.x : y - p.y;
+            if (d - radius <= 0 && first < mid) stack[top++] = {first, mid};
+            if (d + radius >= 0 && mid + 1 < last) stack[top++] = {mid + 1, last};
+        }
+    }
+
+    // Every pair of particles whose boxes overlap, each pair once with a < b
+    // The search region around a particle is a square reaching its radius plus the largest radius in the scene,
+    // which covers every box that can overlap its own
+    void findPairs(PairList& pairs) const {
+        pairs.clear();
+        for (const auto& p : points) {
+            boxQuery(p.x, p.y, p.radius + maxRadius, [&](const Point& other) {
+                if (other.id <= p.id) return;
+                const auto reach = p.radius + other.radius;
+                if (std::abs(p.x - other.x) <= reach && std::abs(p.y - other.y) <= reach)
+                    pairs.push_back({p.id, other.id});
+            });
+        }
+    }
+
+   private:
+    struct Point {
+        Real x;
+        Real y;
+        Real radius;
+        uint32_t id;
+        uint8_t axis;
+    };
+
+    // Median splits keep the tree balanced
+    static constexpr size_t MAX_DEPTH{128};
+
+    // Calls fn(point) for every point within reach of (x, y) on both axes
+    template <typename Fn>
+    void boxQuery(double x, double y, double reach, Fn&& fn) const {
+        std::array<std::pair<uint32_t, uint32_t>, MAX_DEPTH> stack;
+        size_t top{};
+        if (!points.empty()) stack[top++] = {0, static_cast<uint32_t>(points.size())};
+
+        while (top > 0) {
+            const auto [first, last] = stack[--top];
+            const auto mid = first + (last - first) / 2;
+            const auto& p = points[mid];
+
+            if (std::abs(p.x - x) <= reach && std::abs(p.y - y) <= reach) fn(p);
+
+            const auto d = p.axis == 0 ? x - p.x : y - p.y;
+            if (d - reach <= 0 && first < mid) stack[top++] = {first, mid};
+            if (d + reach >= 0 && mid + 1 < last) stack[top++] = {mid + 1, last};
+        }
+    }
+
+    // Iterative so huge scenes cannot overflow the call stack
+    void buildTree() {
+        auto& work = buildStack;
+        work.clear();
+        if (!points.empty()) work.emplace_back(0, points.size());
+        while (!work.empty()) {
+            const auto [lo, hi] = work.back();
+            work.pop_back();
+            if (hi - lo <= 1) {
+                if (hi > lo) points[lo].axis = 0;
+                continue;
+            }
+
+            Real minX{points[lo].x}, maxX{points[lo].x}, minY{points[lo].y}, maxY{points[lo].y};
+            for (auto k = lo + 1; k < hi; k++) {
+                minX = std::min(minX, points[k].x);
+                maxX = std::max(maxX, points[k].x);
+                minY = std::min(minY, points[k].y);
+                maxY = std::max(maxY, points[k].y);
+            }
+            const uint8_t axis = maxX - minX >= maxY - minY ? 0 : 1;
+
+            const auto mid = lo + (hi - lo) / 2;
+            std::nth_element(points.begin() + lo, points.begin() + mid, points.begin() + hi,
+                             [axis](const Point& a, const Point& b) { return axis == 0 ? a.x < b.x : a.y < b.y; });
+            points[mid].axis = axis;
+            work.emplace_back(lo, mid);
+            work.emplace_back(mid + 1, hi);
+        }
+    }
+
+    std::vector<Point> points;
+    std::vector<std::pair<size_t, size_t>> buildStack;
+    Real maxRadius{};
+};
@@ -0,0 +1,74 @@
+#include "ParticleRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void ParticleRenderer::createTexture() {
+    // White disc with a one pixel soft edge so scaled down particles stay smooth
+    sf::Image image;
+    image.create(TEXTURE_SIZE, TEXTURE_SIZE, sf::Color::Transparent);
+    const auto center = static_cast<float>(TEXTURE_SIZE) / 2;
+    for (unsigned py{}; py < TEXTURE_SIZE; py++) {
+        for (unsigned px{}; px < TEXTURE_SIZE; px++) {
+            const auto dx = static_cast<float>(px) + 0.5F - center;
+            const auto dy = static_cast<float>(py) + 0.5F - center;
+            const auto coverage = std::clamp(center - std::sqrt(dx * dx + dy * dy), 0.0F, 1.0F);
+            image.setPixel(px, py, {0xFF, 0xFF, 0xFF, static_cast<uint8_t>(coverage * 0xFF)});
+        }
+    }
+    circle.loadFromImage(image);
+    circle.setSmooth(true);
+    textureReady = true;
+}
+
+void ParticleRenderer::appendQuad(size_t& vertex, float x, float y, float radius, sf::Color color) {
+    const auto size = static_cast<float>(TEXTURE_SIZE);
+    const sf::Vertex topLeft{{x - radius, y - radius}, color, {0, 0}};
+    const sf::Vertex topRight{{x + radius, y - radius}, color, {size, 0}};
+    const sf::Vertex bottomRight{{x + radius, y + radius}, color, {size, size}};
+    const sf::Vertex bottomLeft{{x - radius, y + radius}, color, {0, size}};
+    quads[vertex++] = topLeft;
+    quads[vertex++] = topRight;
+    quads[vertex++] = bottomRight;
+    quads[vertex++] = topLeft;
+    quads[vertex++] = bottomRight;
+    quads[vertex++] = bottomLeft;
+}
+
+sf::Vector2f ParticleRenderer::positionOf(const ParticleSystem& particles, size_t i) const {
+    const auto x = particles.prevX[i] + (particles.x[i] - particles.prevX[i]) * alpha;
+    const auto y = particles.prevY[i] + (particles.y[i] - particles.prevY[i]) * alpha;
+    return {static_cast<float>(x), static_cast<float>(y)};
+}
+
+void ParticleRenderer::render(sf::RenderWindow& win, const ParticleSystem& particles,
+                              const DistanceConstraints& springs, std::span<const size_t> highlighted,
+                              double alpha) {
+    if (!textureReady) createTexture();
+    this->alpha = alpha;
+
+    // The vertex arrays keep their storage between frames so this only allocates when the scene grows
+    quads.resize((particles.size() + highlighted.size()) * 6);
+    size_t vertex{};
+    for (const auto i : highlighted) {
+        const auto [x, y] = positionOf(particles, i);
+        appendQuad(vertex, x, y, static_cast<float>(particles.radius[i]) + HIGHLIGHT_THICKNESS, sf::Color::Red);
+    }
+    for (size_t i{}; i < particles.size(); i++) {
+        const auto [x, y] = positionOf(particles, i);
+        const auto& color = particles.color[i];
+        appendQuad(vertex, x, y, static_cast<float>(particles.radius[i]), {color.r, color.g, color.b, color.a});
+    }
+
+    lines.clear();
+    for (size_t k{}; k < springs.size(); k++) {
+        const auto a = particles.indexOf(springs.getFirst(k));
+        const auto b = particles.indexOf(springs.getSecond(k));
+        if (a == ParticleSystem::NPOS || b == ParticleSystem::NPOS) continue;
+        lines.append({positionOf(particles, a), sf::Color::Black});
+        lines.append({positionOf(particles, b), sf::Color::Black});
+    }
+
+    win.draw(lines);
+    win.draw(quads, &circle);
+}
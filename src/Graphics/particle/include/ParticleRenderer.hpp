@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "DistanceConstraints.hpp"
+#include "ParticleSystem.hpp"
+
+// Draws the whole scene in a fixed number of draw calls
+// Every particle is a quad, two triangles, textured with the same white circle and tinted by its vertex color, so all
+// particles go out in one vertex array and one draw call. Highlighted particles get a larger red quad underneath in
+// the same array which shows as an outline. Springs are one array of lines. Positions are interpolated between the
+// previous and current step by alpha so motion stays smooth when steps and frames do not line up.
+class ParticleRenderer {
+   public:
+    void render(sf::RenderWindow& win, const ParticleSystem& particles, const DistanceConstraints& springs,
+                std::span<const size_t> highlighted, double alpha = 1);
+
+   private:
+    static constexpr unsigned TEXTURE_SIZE{128};
+    static constexpr float HIGHLIGHT_THICKNESS{5};
+
+    void createTexture();
+    void appendQuad(size_t& vertex, float x, float y, float radius, sf::Color color);
+    [[nodiscard]] sf::Vector2f positionOf(const ParticleSystem& particles, size_t i) const;
+
+    sf::Texture circle;
+    bool textureReady{false};
+    double alpha{1};
+    sf::VertexArray quads{sf::Triangles};
+    sf::VertexArray lines{sf::Lines};
+};
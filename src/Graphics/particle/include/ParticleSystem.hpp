@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Vec2.hpp"
+
+// Plain RGBA so the particle store does not depend on a graphics library
+struct Color {
+    uint8_t r{};
+    uint8_t g{};
+    uint8_t b{};
+    uint8_t a{0xFF};
+};
+
+// Stable reference to a particle, stays valid while other particles are added and removed
+struct ParticleHandle {
+    static constexpr uint32_t INVALID{std::numeric_limits<uint32_t>::max()};
+
+    uint32_t id{INVALID};
+    uint32_t generation{};
+
+    [[nodiscard]] bool isNull() const { return id == INVALID; }
+    bool operator==(const ParticleHandle& other) const = default;
+};
+
+// Structure of arrays particle store
+// Every attribute lives in its own contiguous array indexed by a dense slot in [0, size()) so the physics passes
+// stream through memory instead of chasing pointers. Removal moves the last particle into the freed slot, slots are
+// therefore not stable but handles are: a sparse table maps each handle id to its current slot and a per id
+// generation counter rejects handles to particles that have since been removed. Physical quantities are Real, see
+// Vec2.hpp.
+class ParticleSystem {
+   public:
+    static constexpr size_t NPOS{std::numeric_limits<size_t>::max()};
+
+    ParticleHandle add(Real px, Real py, Real pvx, Real pvy, Real pmass, Color pcolor = {}) {
+        uint32_t id;
+        if (freeIds.empty()) {
+            id = static_cast<uint32_t>(slotOf.size());
+            slotOf.push_back(0);
+            generations.push_back(0);
+        } else {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+
+        slotOf[id] = static_cast<uint32_t>(ids.size());
+        ids.push_back(id);
+        x.push_back(px);
+        y.push_back(py);
+        prevX.push_back(px);
+        prevY.push_back(py);
+        vx.push_back(pvx);
+        vy.push_back(pvy);
+        mass.push_back(pmass);
+        radius.push_back(pmass * 2);
+        color.push_back(pcolor);
+        restFrames.push_back(0);
+        dead.push_back(0);
+        asleep.push_back(0);
+        layoutVersion++;
+        return {id, generations[id]};
+    }
+
+    void remove(ParticleHandle handle) {
+        if (const auto i = indexOf(handle); i != NPOS) removeAt(i);
+    }
+
+    // Swap and pop, the particle in the last slot moves into slot i
+    void removeAt(size_t i) {
+        const auto last = size() - 1;
+        const auto id = ids[i];
+        if (dead[i]) deadCount--;
+        if (asleep[i]) sleepingCount--;
+        if (i != last) {
+            x[i] = x[last];
+            y[i] = y[last];
+            prevX[i] = prevX[last];
+            prevY[i] = prevY[last];
+            vx[i] = vx[last];
+            vy[i] = vy[last];
+            mass[i] = mass[last];
+            radius[i] = radius[last];
+            color[i] = color[last];
+            restFrames[i] = restFrames[last];
+            dead[i] = dead[last];
+            asleep[i] = asleep[last];
+            ids[i] = ids[last];
+            slotOf[ids[i]] = static_cast<uint32_t>(i);
+        }
+        popBack();
+        retire(id);
+        layoutVersion++;
+    }
+
+    // Flags the particle for removal by the next compact, it stays in place and its handle stays valid until then
+    void markDead(size_t i) {
+        if (dead[i]) return;
+        dead[i] = 1;
+        deadCount++;
+    }
+
+    void markDead(ParticleHandle handle) {
+        if (const auto i = indexOf(handle); i != NPOS) markDead(i);
+    }
+
+    [[nodiscard]] bool isDead(size_t i) const { return dead[i] != 0; }
+    [[nodiscard]] size_t getDeadCount() const { return deadCount; }
+
+    // A sleeping particle is left out of integration and of pairs with other sleeping particles until it is woken,
+    // it stops where it is
+    void sleep(size_t i) {
+        vx[i] = 0;
+        vy[i] = 0;
+        if (asleep[i]) return;
+        asleep[i] = 1;
+        sleepingCount++;
+    }
+
+    void wake(size_t i) {
+        restFrames[i] = 0;
+        if (!asleep[i]) return;
+        asleep[i] = 0;
+        sleepingCount--;
+    }
+
+    [[nodiscard]] bool isAsleep(size_t i) const { return asleep[i] != 0; }
+    [[nodiscard]] size_t getSleepingCount() const { return sleepingCount; }
+    // One byte per slot, 1 when the particle sleeps
+    [[nodiscard]] const std::vector<uint8_t>& getSleepMask() const { return asleep; }
+
+    // Removes every particle marked dead in a single pass, the survivors slide down and keep their relative order
+    void compact() {
+        if (deadCount == 0) return;
+        const auto n = size();
+        auto write = static_cast<size_t>(std::ranges::find(dead, 1) - dead.begin());
+        for (auto read = write; read < n; read++) {
+            if (dead[read]) {
+                if (asleep[read]) sleepingCount--;
+                retire(ids[read]);
+                continue;
+            }
+            x[write] = x[read];
+            y[write] = y[read];
+            prevX[write] = prevX[read];
+            prevY[write] = prevY[read];
+            vx[write] = vx[read];
+            vy[write] = vy[read];
+            mass[write] = mass[read];
+            radius[write] = radius[read];
+            color[write] = color[read];
+            restFrames[write] = restFrames[read];
+            asleep[write] = asleep[read];
+            ids[write] = ids[read];
+            slotOf[ids[write]] = static_cast<uint32_t>(write);
+            write++;
+        }
+        resize(write);
+        std::ranges::fill(dead, 0);
+        deadCount = 0;
+        layoutVersion++;
+    }
+
+    void clear() {
+        for (const auto id : ids) retire(id);
+        x.clear();
+        y.clear();
+        prevX.clear();
+        prevY.clear();
+        vx.clear();
+        vy.clear();
+        mass.clear();
+        radius.clear();
+        color.clear();
+        restFrames.clear();
+        dead.clear();
+        asleep.clear();
+        ids.clear();
+        deadCount = 0;
+        sleepingCount = 0;
+        layoutVersion++;
+    }
+
+    void reserve(size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        prevX.reserve(n);
+        prevY.reserve(n);
+        vx.reserve(n);
+        vy.reserve(n);
+        mass.reserve(n);
+        radius.reserve(n);
+        color.reserve(n);
+        restFrames.reserve(n);
+        dead.reserve(n);
+        asleep.reserve(n);
+        ids.reserve(n);
+        slotOf.reserve(n);
+        generations.reserve(n);
+    }
+
+    // Particles that fit before the arrays reallocate
+    [[nodiscard]] size_t capacity() const { return x.capacity(); }
+
+    // Current slot of the particle or NPOS if it has been removed
+    [[nodiscard]] size_t indexOf(ParticleHandle handle) const {
+        if (handle.id >= slotOf.size() || generations[handle.id] != handle.generation) return NPOS;
+        return slotOf[handle.id];
+    }
+
+    [[nodiscard]] bool contains(ParticleHandle handle) const { return indexOf(handle) != NPOS; }
+
+    [[nodiscard]] ParticleHandle handleAt(size_t i) const { return {ids[i], generations[ids[i]]}; }
+
+    [[nodiscard]] size_t size() const { return ids.size(); }
+    // Changes whenever a particle is added, removed or moved to another slot, anything indexed by slot that was built
+    // at another version is stale
+    [[nodiscard]] uint64_t getLayoutVersion() const { return layoutVersion; }
+    [[nodiscard]] bool empty() const { return ids.empty(); }
+
+    // Remembers the current positions as the previous ones, called at the start of every step
+    void savePositions() {
+        prevX.assign(x.begin(), x.end());
+        prevY.assign(y.begin(), y.end());
+    }
+
+    void applyForce(size_t i, Real fx, Real fy) {
+        // As F = ma, a = F/m and acceleration is the change in velocity
+        vx[i] += fx / mass[i];
+        vy[i] += fy / mass[i];
+    }
+
+    std::vector<Real> x;
+    std::vector<Real> y;
+    std::vector<Real> prevX;  // Position at the start of the last step, for render interpolation
+    std::vector<Real> prevY;
+    std::vector<Real> vx;
+    std::vector<Real> vy;
+    std::vector<Real> mass;
+    std::vector<Real> radius;
+    std::vector<Color> color;
+    std::vector<uint16_t> restFrames;  // Consecutive steps the particle has been at rest
+
+   private:
+    // The id can be handed out again, handles to the old particle no longer resolve
+    void retire(uint32_t id) {
+        generations[id]++;
+        freeIds.push_back(id);
+    }
+
+    void resize(size_t n) {
+        x.resize(n);
+        y.resize(n);
+        prevX.resize(n);
+        prevY.resize(n);
+        vx.resize(n);
+        vy.resize(n);
+        mass.resize(n);
+        radius.resize(n);
+        color.resize(n);
+        restFrames.resize(n);
+        dead.resize(n);
+        asleep.resize(n);
+        ids.resize(n);
+    }
+
+    void popBack() {
+        x.pop_back();
+        y.pop_back();
+        prevX.pop_back();
+        prevY.pop_back();
+        vx.pop_back();
+        vy.pop_back();
+        mass.pop_back();
+        radius.pop_back();
+        color.pop_back();
+        restFrames.pop_back();
+        dead.pop_back();
+        asleep.pop_back();
+        ids.pop_back();
+    }
+
+    std::vector<uint8_t> dead;  // Marked for removal by the next compact
+    size_t deadCount{};
+    std::vector<uint8_t> asleep;
+    size_t sleepingCount{};
+    std::vector<uint32_t> ids;          // Slot to handle id
+    std::vector<uint32_t> slotOf;       // Handle id to slot
+    std::vector<uint32_t> generations;  // Handle id to generation
+    std::vector<uint32_t> freeIds;
+    uint64_t layoutVersion{};
+};
@@ -1,17 +1,29 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <csignal>
-#include <mlinalg/MLinalg.hpp>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
 #include <vector>
 
-#include "Particle.hpp"
+#include "Bvh.hpp"
+#include "KdTree.hpp"
+#include "ParticleSystem.hpp"
+#include "SweepAndPrune.hpp"
+#include "SweptCollisions.hpp"
+#include "UniformGrid.hpp"
+#include "Vec2.hpp"
+#include "aliases.hpp"
+#include "kernels.hpp"
+#include "multithreading.hpp"
 
-using namespace mlinalg;
-using ParticleGroups = std::vector<std::vector<PartPtr>>;
-using Partices = std::vector<PartPtr>;
-
-enum class CollisionDetection { SWEEP_AND_PRUNE = 0, UNI_SPACE_PART, KD_TREE, BVH_TREE };
+enum class CollisionDetection { SWEEP_AND_PRUNE = 0, UNI_SPACE_PART, KD_TREE, BVH_TREE, SWEEP_AND_PRUNE_DUAL_AXIS };
+inline constexpr int COLLISION_METHOD_COUNT{5};
 
 inline std::string parseCollisionMethods(CollisionDetection method) {
     switch (method) {
@@ -23,19 +35,78 @@ inline std::string parseCollisionMethods(CollisionDetection method) {
             return "KD Tree";
         case CollisionDetection::BVH_TREE:
             return "Bounding Volume Hierarchy";
+        case CollisionDetection::SWEEP_AND_PRUNE_DUAL_AXIS:
+            return "Sweep and Prune (Dual Axis)";
     }
+    return "Unknown";
 }
 
-struct Physics {
-    Physics(double dt, Partices& particles) : dt{dt}, particles{particles} {}
+// Narrow-phase counters for the last frame
+struct CollisionStats {
+    size_t candidates{};
+    size_t hits{};
+    size_t swept{};      // Particles swept by continuous collision detection
+    size_t sweptHits{};  // Contacts it found along their paths
+
+    [[nodiscard]] double hitRate() const {
+        return candidates > 0 ? static_cast<double>(hits) / static_cast<double>(candidates) : 0;
+    }
+};
 
-    [[nodiscard]] virtual Vector2<double> collisionResponse(const Vector2<double>& v,
-                                                            const Vector2<double>& n) const = 0;
-    virtual void handleBoxCollision(const PartPtr& particle) = 0;
-    virtual void handleParticleCollision() = 0;
+struct Physics {
+    Physics(double dt, ParticleSystem& particles) : dt{dt}, particles{particles} {}
+
+    [[nodiscard]] virtual Vec2r collisionResponse(Vec2r v, Vec2r n) const = 0;
+    virtual void handleBoxCollision(size_t i) = 0;
+    // Broad-phase, finds the pairs of particles that may touch
+    virtual void findCandidatePairs() = 0;
+    // Narrow-phase, resolves the candidate pairs that do touch
+    virtual void resolveCandidatePairs() = 0;
+    // Pairs found by the last broad-phase
+    [[nodiscard]] virtual const PairList& candidatePairs() const = 0;
+    // Grid the last broad-phase binned the particles into, nullptr when it used another structure or particles have
+    // been added or removed since
+    [[nodiscard]] virtual const UniformGrid* broadPhaseGrid() const { return nullptr; }
+
+    void handleParticleCollision() {
+        findCandidatePairs();
+        resolveCandidatePairs();
+    }
 
     virtual ~Physics() = default;
 
+    // Wall collisions followed by integration for every particle that is awake
+    virtual void stepParticles() {
+        for (size_t i{}; i < particles.size(); i++) {
+            if (particles.isAsleep(i)) continue;
+            handleBoxCollision(i);
+            integrate(i);
+        }
+    }
+
+    [[nodiscard]] kernels::StepParams stepParams() const {
+        const auto g = gravity.as<Real>();
+        return {static_cast<Real>(dt),
+                g.x,
+                g.y,
+                static_cast<Real>(e),
+                static_cast<Real>(frictionCoef),
+                static_cast<Real>(borderXMin),
+                static_cast<Real>(borderXMax),
+                static_cast<Real>(borderYMin),
+                static_cast<Real>(borderYMax)};
+    }
+
+    void integrate(size_t i) {
+        // Euler's method
+        const auto g = gravity.as<Real>();
+        const auto step = static_cast<Real>(dt);
+        particles.vx[i] += g.x * particles.mass[i] * step;
+        particles.vy[i] += g.y * particles.mass[i] * step;
+        particles.x[i] += particles.vx[i] * step;
+        particles.y[i] += particles.vy[i] * step;
+    }
+
     void setWinDim(float borderXMin, float borderXMax, float borderYMin, float borderYMax) {
         this->borderXMin = borderXMin;
         this->borderXMax = borderXMax;
@@ -44,381 +115,309 @@ struct Physics {
     }
 
     CollisionDetection collisionMethod{CollisionDetection::UNI_SPACE_PART};
+    // Resolves collisions in color order instead of pair order, the result does not depend on the thread count
+    bool parallel{false};
+    // Sweeps particles that move further than their radius in a step for the contacts the discrete phases miss
+    bool continuous{false};
+    ParallelStep parallelStep{1};
     float borderXMin;
     float borderYMin;
     float borderXMax;
     float borderYMax;
-    Vector2<double> nL{1, 0};       // Normal vector for left wall
-    Vector2<double> nR{-1, 0};      // Normal vector for right wall
-    Vector2<double> nB{0, -1};      // Normal vector for bottom wall
-    Vector2<double> nT{0, 1};       // Normal vector for top wall
-    double e{0.5};                  // Elasticity
-    Vector2<double> gravity{0, 0};  // Global gravity
+    Vec2r nL{1, 0};       // Normal vector for left wall
+    Vec2r nR{-1, 0};      // Normal vector for right wall
+    Vec2r nB{0, -1};      // Normal vector for bottom wall
+    Vec2r nT{0, 1};       // Normal vector for top wall
+    double e{0.5};        // Elasticity
+    Vec2d gravity{0, 0};  // Global gravity
     double frictionCoef{0.3};
     double dt{};  // Time step
-    Partices& particles;
+    CollisionStats collisionStats;
+    ParticleSystem& particles;
 };
 
+// Narrow-phase between particle pairs
+// Candidate pairs are resolved in order, each pair sees the positions and velocities left by the pairs before it. The
+// overlap test for a batch of pairs is computed up front in straight loops the compiler vectorizes, most candidates
+// miss so only the hits reach the scalar response. A pair whose particle was moved by an earlier hit in the same batch
+// is tested again before it is resolved.
 struct CollisionHandler {
    private:
-    double& frictionCoef;
-    static constexpr double EPSILON{1e-5};
-    const Vector2<double> EPSILON_VEC{EPSILON * Vector2<double>{1, 1}};
-
-    struct CollisionData {
-        Vector2<double> normal;
-        double depth;
-    };
-
-    struct ParticleData {
-        Vector2<double> pos;
-        Vector2<double> vel;
-        double radius;
-        double mass;
-    };
-
-    Vector2<double> calculatePositionCorrection(const Vector2<double>& normal, double overlap,
-                                                double biasFactor = 0.2) {
-        return normal * (overlap * biasFactor);
-    }
-
-    [[nodiscard]] bool isColliding(const ParticleData& p1, const ParticleData& p2) const {
-        double distance = (p1.pos - p2.pos).length();
-        double radiusSum = p1.radius + p2.radius;
-        return distance <= radiusSum + EPSILON;
-    }
-
-    [[nodiscard]] auto calculateNormal(const Vector2<double>& pos1, const Vector2<double>& pos2) const {
-        auto posDiff = pos2 - pos1;
-        return posDiff / (posDiff.length() + EPSILON);
-    }
-
-    [[nodiscard]] auto calculateDepth(const Vector2<double>& pos, const Vector2<double>& otherPos, double radius,
-                                      double otherRadius) const {
-        return 2 * otherRadius - (otherPos - pos).length();
-    }
-
-    ParticleData createParticleData(const PartPtr& particle) const {
-        return {particle->gPos(), particle->gVel(), particle->gRadius(), particle->gMass() * 1.0};
-    }
-
-    [[nodiscard]] CollisionData calculateCollisionData(const ParticleData& particle,
-                                                       const ParticleData& otherParticle) {
-        auto normal = calculateNormal(particle.pos, otherParticle.pos);
-        auto depth = calculateDepth(particle.pos, otherParticle.pos, particle.radius, otherParticle.radius);
-        return {normal, depth};
-    }
-
-    ParticleData calculateNewParticleData(const ParticleData& particle, const ParticleData& otherParticle,
-                                          const CollisionData& colData) {
-        const auto [normal, depth] = colData;
-        const auto& [pos, vel, radius, mass] = particle;
-        const auto& [otherPos, otherVel, otherRadius, otherMass] = otherParticle;
-
-        auto massComponent = (2 * otherMass) / ((mass + otherMass) + EPSILON);
-        auto centerDiff = pos - otherPos;
-        auto vCInner = (vel - otherVel) * centerDiff;
-        auto centerDiffNorm = centerDiff.length();
-        auto newVel = vel - static_cast<double>(massComponent) *
-                                (vCInner / ((centerDiffNorm * centerDiffNorm) + EPSILON)).at(0) * centerDiff;
-        auto newPos = pos - normal * depth / 2;
-        // auto newPos = pos - calculatePositionCorrection(normal, depth / 2);
-        return {newPos, newVel, radius, mass};
-    }
-
-    ParticleData applyFriction(const ParticleData& particle, const ParticleData& otherParticle,
-                               const CollisionData& colData) {
-        const auto [normal, depth] = colData;
-        const auto& [pos, vel, radius, mass] = particle;
+    static constexpr Real EPSILON{1e-5};
+    static constexpr size_t BATCH{8};
 
-        const auto& [otherPos, otherVel, otherRadius, otherMass] = otherParticle;
-
-        auto velDiff = vel - otherVel;
-        auto normComp = (normal * (velDiff)).at(0) * normal;
-        auto tanComp = vel - normComp;
-        auto tanVelWF = tanComp * (1 - frictionCoef);
-        auto newVelWF = normComp + tanVelWF;
+    double& frictionCoef;
 
-        return {pos, newVelWF, radius, mass};
+    // New velocities and a push apart that moves the smaller particle further
+    void respond(ParticleSystem& particles, size_t i, size_t j, Real dx, Real dy, Real distSq) const {
+        const auto dist = std::sqrt(distSq);
+        const auto inv = 1 / (dist + EPSILON);
+        const auto nx = dx * inv;
+        const auto ny = dy * inv;
+        const auto pushI = particles.radius[j] - dist / 2;
+        const auto pushJ = particles.radius[i] - dist / 2;
+
+        exchangeVelocities(particles, i, j, dx, dy, distSq, nx, ny);
+        particles.x[i] -= nx * pushI;
+        particles.y[i] -= ny * pushI;
+        particles.x[j] += nx * pushJ;
+        particles.y[j] += ny * pushJ;
     }
 
-    void applyCollision(const PartPtr& particle, const ParticleData& newParticleData) {
-        particle->sVel(newParticleData.vel);
-        particle->sPos(newParticleData.pos);
+    // Elastic impulse along the line of centers, then friction on the tangential part of the velocity relative to the
+    // other particle
+    void exchangeVelocities(ParticleSystem& particles, size_t i, size_t j, Real dx, Real dy, Real distSq, Real nx,
+                            Real ny) const {
+        const auto vxi = particles.vx[i];
+        const auto vyi = particles.vy[i];
+        const auto vxj = particles.vx[j];
+        const auto vyj = particles.vy[j];
+        const auto mi = particles.mass[i];
+        const auto mj = particles.mass[j];
+
+        // (vi - vj) . (pi - pj) is the same seen from either particle
+        const auto k = ((vxi - vxj) * -dx + (vyi - vyj) * -dy) / (distSq + EPSILON);
+        const auto ki = 2 * mj / (mi + mj + EPSILON) * k;
+        const auto kj = 2 * mi / (mi + mj + EPSILON) * k;
+
+        auto newVxi = vxi + ki * dx;
+        auto newVyi = vyi + ki * dy;
+        auto newVxj = vxj - kj * dx;
+        auto newVyj = vyj - kj * dy;
+
+        const auto keep = 1 - static_cast<Real>(frictionCoef);
+        const auto ni = nx * (newVxi - vxj) + ny * (newVyi - vyj);
+        newVxi = ni * nx + (newVxi - ni * nx) * keep;
+        newVyi = ni * ny + (newVyi - ni * ny) * keep;
+        const auto nj = nx * (newVxj - vxi) + ny * (newVyj - vyi);
+        newVxj = nj * nx + (newVxj - nj * nx) * keep;
+        newVyj = nj * ny + (newVyj - nj * ny) * keep;
+
+        particles.vx[i] = newVxi;
+        particles.vy[i] = newVyi;
+        particles.vx[j] = newVxj;
+        particles.vy[j] = newVyj;
     }
 
    public:
     CollisionHandler(double& frictionCoef) : frictionCoef{frictionCoef} {}
 
-    void handleCollision(const PartPtr& particle, const PartPtr& otherParticle) {
-        // Create particle data
-        auto particleData = createParticleData(particle);
-        auto otherParticleData = createParticleData(otherParticle);
-
-        // Check if particles are colliding
-        if (!isColliding(particleData, otherParticleData)) return;
-
-        // Calculate collision data
-        auto collisionData = calculateCollisionData(particleData, otherParticleData);
-        auto otherCollisionData = calculateCollisionData(otherParticleData, particleData);
+    // Returns whether the particles were touching
+    bool handleCollision(ParticleSystem& particles, size_t i, size_t j) const {
+        const auto dx = particles.x[j] - particles.x[i];
+        const auto dy = particles.y[j] - particles.y[i];
+        const auto reach = particles.radius[i] + particles.radius[j] + EPSILON;
+        const auto distSq = dx * dx + dy * dy;
+        if (distSq > reach * reach) return false;
+        respond(particles, i, j, dx, dy, distSq);
+        return true;
+    }
 
-        // Calculate new particle data
-        auto pData = calculateNewParticleData(particleData, otherParticleData, collisionData);
-        auto otherPData = calculateNewParticleData(otherParticleData, particleData, otherCollisionData);
+    // Velocities after the particles hit, for particles that only just touch and need no push apart
+    void bounce(ParticleSystem& particles, size_t i, size_t j) const {
+        const auto dx = particles.x[j] - particles.x[i];
+        const auto dy = particles.y[j] - particles.y[i];
+        const auto distSq = dx * dx + dy * dy;
+        const auto inv = 1 / (std::sqrt(distSq) + EPSILON);
+        exchangeVelocities(particles, i, j, dx, dy, distSq, dx * inv, dy * inv);
+    }
 
-        // Apply friction
-        auto pDataWF = applyFriction(pData, otherParticleData, collisionData);
-        auto otherPDataWF = applyFriction(otherPData, particleData, otherCollisionData);
+    // Resolves every candidate pair and returns how many were touching
+    size_t handleCollisions(ParticleSystem& particles, std::span<const CandidatePair> pairs) const {
+        std::array<Real, BATCH> dx, dy, distSq, reachSq;
+        std::array<bool, BATCH> hit;
+        size_t hits{};
+
+        for (size_t first{}; first < pairs.size(); first += BATCH) {
+            const auto count = std::min(BATCH, pairs.size() - first);
+            const auto* batch = pairs.data() + first;
+
+            for (size_t k{}; k < count; k++) {
+                const auto [a, b] = batch[k];
+                dx[k] = particles.x[b] - particles.x[a];
+                dy[k] = particles.y[b] - particles.y[a];
+                const auto reach = particles.radius[a] + particles.radius[b] + EPSILON;
+                reachSq[k] = reach * reach;
+            }
+            for (size_t k{}; k < count; k++) {
+                distSq[k] = dx[k] * dx[k] + dy[k] * dy[k];
+                hit[k] = distSq[k] <= reachSq[k];
+            }
 
-        // Apply collision to particles
-        applyCollision(particle, pDataWF);
-        applyCollision(otherParticle, otherPDataWF);
+            // Particles moved by the hits resolved so far in this batch
+            std::array<uint32_t, 2 * BATCH> moved;
+            size_t movedCount{};
+            const auto wasMoved = [&](uint32_t id) {
+                return std::find(moved.begin(), moved.begin() + movedCount, id) != moved.begin() + movedCount;
+            };
+
+            for (size_t k{}; k < count; k++) {
+                const auto [a, b] = batch[k];
+                if (movedCount > 0 && (wasMoved(a) || wasMoved(b))) {
+                    if (!handleCollision(particles, a, b)) continue;
+                } else if (hit[k]) {
+                    respond(particles, a, b, dx[k], dy[k], distSq[k]);
+                } else {
+                    continue;
+                }
+                hits++;
+                moved[movedCount++] = a;
+                moved[movedCount++] = b;
+            }
+        }
+        return hits;
     }
 };
 
 struct SimplePhysics : public Physics {
-    Vector2<int>& dim;
     CollisionHandler collisionHandler{frictionCoef};
 
-    SimplePhysics(double dt, Partices& particles, Vector2<int>& dim, float borderXMin = 0, float borderXMax = 0,
+    SimplePhysics(double dt, ParticleSystem& particles, float borderXMin = 0, float borderXMax = 0,
                   float borderYMin = 0, float borderYMax = 0)
-        : Physics{dt, particles}, dim{dim} {
+        : Physics{dt, particles} {
         setWinDim(borderXMin, borderXMax, borderYMin, borderYMax);
     }
 
     ~SimplePhysics() override = default;
 
-    [[nodiscard]] Vector2<double> collisionResponse(const Vector2<double>& v, const Vector2<double>& n) const override {
+    [[nodiscard]] Vec2r collisionResponse(Vec2r v, Vec2r n) const override {
         // velocity after collision = velocity - (1 + elasticity) * normal * (velocity dot normal)
         // This inverts the velocity component that is perpendicular to the normal
         // Taking into account friction velocity after collision is now
         // velocity - (1 + elasticity) * normal velocity - friction coefficient * tangential velocity * time step
         // Where normal velocity = normal * (velocity * normal) and
         // tangential velocity = velocity - normal velocity
-        auto vn = n * (v * n).at(0);
-        auto vt = v - vn;
-        return v - (1 + e) * vn - frictionCoef * vt * dt;
+        const auto vn = n * v.dot(n);
+        const auto vt = v - vn;
+        return v - vn * (1 + static_cast<Real>(e)) - vt * static_cast<Real>(frictionCoef) * static_cast<Real>(dt);
     }
 
-    void handleBoxCollision(const PartPtr& particle) override {
-        const auto& pos = particle->gPos();
-        const auto& vel = particle->gVel();
-        const auto& radius = particle->gRadius();
+    // Walls are resolved one after another on the updated state so a particle in a corner bounces off both
+    void handleBoxCollision(size_t i) override {
+        Vec2r pos{particles.x[i], particles.y[i]};
+        Vec2r vel{particles.vx[i], particles.vy[i]};
+        const auto radius = particles.radius[i];
 
         // Left wall collision
-        if (pos.at(0) - radius <= borderXMin) {
-            if ((vel * nL).at(0) < 0) {  // Check if the object is moving towards the wall
-                auto newVel = collisionResponse(vel, nL);
-                particle->sVel(newVel);
+        if (pos.x - radius <= borderXMin) {
+            if (vel.dot(nL) < 0) {  // Check if the object is moving towards the wall
+                vel = collisionResponse(vel, nL);
 
-                auto depth = -(pos.at(0) - radius);
-                particle->sPos(pos + nL * depth);
+                auto depth = borderXMin - (pos.x - radius);
+                pos = pos + nL * depth;
             }
         }
 
         // Right wall collision
-        if (pos.at(0) + radius >= borderXMax) {
-            if ((vel * nR).at(0) < 0) {  // Check if the object is moving towards the wall
-                auto newVel = collisionResponse(vel, nR);
-                particle->sVel(newVel);
+        if (pos.x + radius >= borderXMax) {
+            if (vel.dot(nR) < 0) {  // Check if the object is moving towards the wall
+                vel = collisionResponse(vel, nR);
 
-                auto depth = (pos.at(0) - radius) - borderXMax + radius * 2;
-                particle->sPos(pos + nR * depth);
+                auto depth = (pos.x - radius) - borderXMax + radius * 2;
+                pos = pos + nR * depth;
             }
         }
 
         // Bottom wall collision
-        if (pos.at(1) + radius >= borderYMax) {
-            if ((vel * nB).at(0) < 0) {  // Check if the object is moving towards the wall
-                auto newVel = collisionResponse(vel, nB);
-                particle->sVel(newVel);
+        if (pos.y + radius >= borderYMax) {
+            if (vel.dot(nB) < 0) {  // Check if the object is moving towards the wall
+                vel = collisionResponse(vel, nB);
 
-                auto depth = (pos.at(1) - radius) - borderYMax + radius * 2;
-                particle->sPos(pos + nB * depth);
+                auto depth = (pos.y - radius) - borderYMax + radius * 2;
+                pos = pos + nB * depth;
             }
         }
 
         // Top wall collision
-        if (pos.at(1) - radius <= borderYMin) {
-            if ((vel * nT).at(0) < 0) {  // Check if the object is moving towards the wall
-                auto newVel = collisionResponse(vel, nT);
-                particle->sVel(newVel);
+        if (pos.y - radius <= borderYMin) {
+            if (vel.dot(nT) < 0) {  // Check if the object is moving towards the wall
+                vel = collisionResponse(vel, nT);
 
-                auto depth = -(pos.at(1) - radius);
-                particle->sPos(pos + nT * depth);
+                auto depth = borderYMin - (pos.y - radius);
+                pos = pos + nT * depth;
             }
         }
+
+        particles.x[i] = pos.x;
+        particles.y[i] = pos.y;
+        particles.vx[i] = vel.x;
+        particles.vy[i] = vel.y;
     }
 
-    void handleParticleCollision() override {
-        ParticleGroups particleGroups;
+    // Same result as handleBoxCollision followed by integrate for every particle, computed by the vectorized kernel,
+    // then the contacts along the paths of fast particles
+    void stepParticles() override {
+        const auto params = stepParams();
+        if (parallel)
+            parallelStep.integrate(particles, params);
+        else
+            kernels::integrateAndCollideWalls(particles, params);
+
+        collisionStats.swept = collisionStats.sweptHits = 0;
+        if (!continuous) return;
+        collisionStats.sweptHits = sweptCollisions.resolve(
+            particles, params, [this](size_t i, size_t j) { collisionHandler.bounce(particles, i, j); });
+        collisionStats.swept = sweptCollisions.getSwept();
+    }
+
+    // Every method leaves the candidate pairs in pairs, none of them between two sleeping particles
+    void findCandidatePairs() override {
+        gridLayout.reset();
         switch (collisionMethod) {
             case CollisionDetection::SWEEP_AND_PRUNE:
-                particleGroups = sweepAndPrune();
+                sweepAndPrune.findPairs(particles, pairs, SweepAndPrune::Mode::SINGLE_AXIS);
+                break;
+            case CollisionDetection::SWEEP_AND_PRUNE_DUAL_AXIS:
+                sweepAndPrune.findPairs(particles, pairs, SweepAndPrune::Mode::DUAL_AXIS);
                 break;
             case CollisionDetection::UNI_SPACE_PART:
-                particleGroups = uniSpacePartitioning();
+                grid.build(particles);
+                grid.findPairs(pairs);
+                gridLayout = particles.getLayoutVersion();
                 break;
             case CollisionDetection::KD_TREE:
-                particleGroups = kdTree();
+                kdTree.build(particles);
+                kdTree.findPairs(pairs);
                 break;
             case CollisionDetection::BVH_TREE:
-                particleGroups = bvhTree();
+                bvh.update(particles);
+                bvh.findPairs(particles, pairs);
                 break;
         }
-
-        for (const auto& particles : particleGroups) {
-            handleParticleCollision(particles.at(0), particles);
+        // The grid already leaves them out, the other structures still hold sleeping particles so their pairs are
+        // filtered afterwards
+        if (particles.getSleepingCount() > 0 && collisionMethod != CollisionDetection::UNI_SPACE_PART) {
+            std::erase_if(pairs, [this](const CandidatePair& pair) {
+                return particles.isAsleep(pair.a) && particles.isAsleep(pair.b);
+            });
         }
     }
 
-    void handleParticleCollision(const PartPtr& particle, const std::vector<PartPtr>& particles) {
-        for (const auto& otherParticle : particles) {
-            if (otherParticle == particle) continue;
-            collisionHandler.handleCollision(particle, otherParticle);
+    void resolveCandidatePairs() override {
+        collisionStats.candidates = pairs.size();
+        if (parallel) {
+            collisionStats.hits = parallelStep.resolvePairs(pairs, particles.size(), [this](auto batch) {
+                return collisionHandler.handleCollisions(particles, batch);
+            });
+        } else {
+            collisionStats.hits = collisionHandler.handleCollisions(particles, pairs);
         }
     }
 
-    // Broad-phase collision detection methods
-    ParticleGroups sweepAndPrune(bool xAxis = true) {
-        std::vector<std::vector<PartPtr>> res;
-        std::sort(particles.begin(), particles.end(), [&xAxis](const PartPtr& a, const PartPtr& b) {
-            if (xAxis) {
-                return a->gPos().at(0) < b->gPos().at(0);
-            } else {
-                return a->gPos().at(1) < b->gPos().at(1);
-            }
-        });
-
-        std::vector<PartPtr> activeIntervals;
-        for (const auto& particle : particles) {
-            const auto& pos = particle->gPos();
-            const auto& radius = particle->gRadius();
-            activeIntervals.erase(
-                std::remove_if(activeIntervals.begin(), activeIntervals.end(),
-                               [&](const PartPtr& p) {
-                                   const auto& otherPos = p->gPos();
-                                   const auto& otherRadius = p->gRadius();
-                                   int axisIndex = xAxis ? 0 : 1;
-                                   return (pos.at(axisIndex) - radius > otherPos.at(axisIndex) + otherRadius);
-                               }),
-                activeIntervals.end());
-            activeIntervals.push_back(particle);
-            if (activeIntervals.size() > 1) res.push_back(activeIntervals);
-        }
+    [[nodiscard]] const PairList& candidatePairs() const override { return pairs; }
 
-        return res;
+    [[nodiscard]] const UniformGrid* broadPhaseGrid() const override {
+        return gridLayout == particles.getLayoutVersion() ? &grid : nullptr;
     }
 
-    ParticleGroups uniSpacePartitioning(size_t gridSpace = 10) {
-        // Make grid from screen
-        vector<vector<PartPtr>> res;
-        using std::vector;
-        auto rows = (size_t)std::ceil(dim.at(1) / (double)gridSpace);
-        auto cols = (size_t)std::ceil(dim.at(0) / (double)gridSpace);
-        // cout << std::format("Rows: {}, Cols: {}\n", rows, cols);
-        vector<vector<vector<PartPtr>>> grid(rows, vector<vector<PartPtr>>(cols, vector<PartPtr>{}));
-
-        // Assign particles to cells
-        for (const auto& particle : particles) {
-            const auto& pos = particle->gPos();
-            auto row = std::min((size_t)pos.at(1) / gridSpace, rows - 1);
-            auto col = std::min((size_t)pos.at(0) / gridSpace, cols - 1);
-            grid[row][col].push_back(particle);
-        }
-
-        // Only particles in the same cells should be checked for collisions
-        res.reserve(rows * cols);
-        for (size_t i{}; i < rows; i++) {
-            for (size_t j{}; j < cols; j++) {
-                if (grid[i][j].size() > 1) res.push_back(grid[i][j]);
-            }
-        }
-        return res;
-    }
-
-    void buildKdTree(ParticleGroups& groups, std::vector<PartPtr>& particles, bool xAxis) {
-        constexpr size_t baseThreshold = 20;
-        size_t threshold = std::max(baseThreshold, particles.size() / 10);
-
-        if (particles.size() <= threshold) {
-            if (particles.size() > 1) groups.push_back(particles);
-            return;
-        }
-
-        // Find the median index
-        size_t median = particles.size() / 2;
-
-        std::nth_element(particles.begin(), particles.begin() + median, particles.end(),
-                         [xAxis](const PartPtr& a, const PartPtr& b) {
-                             return (xAxis ? a->gPos().at(0) : a->gPos().at(1)) <
-                                    (xAxis ? b->gPos().at(0) : b->gPos().at(1));
-                         });
-
-        // Split into left and right subgroups
-        std::vector<PartPtr> left(particles.begin(), particles.begin() + median);
-        std::vector<PartPtr> right(particles.begin() + median + 1, particles.end());
-
-        // Recurse on left and right groups along the next axis
-        buildKdTree(groups, left, !xAxis);
-        buildKdTree(groups, right, !xAxis);
-    }
-
-    ParticleGroups kdTree(bool xAxis = false) {
-        std::vector<std::vector<PartPtr>> res;
-        buildKdTree(res, particles, false);
-        return res;
-    }
-
-    void buildBVH(ParticleGroups& groups, std::vector<PartPtr>& particles, size_t start, size_t end) {
-        constexpr size_t baseThreshold = 20;
-        size_t particleCount = end - start;
-
-        // Threshold for creating leaf nodes
-        size_t threshold = std::max(baseThreshold, particleCount / 10);
-        if (particleCount <= threshold) {
-            if (particleCount > 1) {
-                groups.emplace_back(particles.begin() + start, particles.begin() + end);
-            }
-            return;
-        }
-
-        // Compute bounding box
-        double xMin = std::numeric_limits<double>::max();
-        double xMax = std::numeric_limits<double>::lowest();
-        double yMin = std::numeric_limits<double>::max();
-        double yMax = std::numeric_limits<double>::lowest();
-
-        for (size_t i = start; i < end; ++i) {
-            const auto& pos = particles[i]->gPos();
-            xMin = std::min(xMin, pos.at(0));
-            xMax = std::max(xMax, pos.at(0));
-            yMin = std::min(yMin, pos.at(1));
-            yMax = std::max(yMax, pos.at(1));
-        }
-
-        // Decide the splitting axis based on bounding box dimensions
-        bool splitAxis = (xMax - xMin) > (yMax - yMin);
-
-        // Find the median index for splitting
-        size_t median = start + particleCount / 2;
-        std::nth_element(particles.begin() + start, particles.begin() + median, particles.begin() + end,
-                         [splitAxis](const PartPtr& a, const PartPtr& b) {
-                             return splitAxis ? a->gPos().at(0) < b->gPos().at(0) : a->gPos().at(1) < b->gPos().at(1);
-                         });
-
-        // Recurse on left and right subgroups
-        buildBVH(groups, particles, start, median);
-        buildBVH(groups, particles, median + 1, end);
-    }
-
-    ParticleGroups bvhTree() {
-        ParticleGroups groups;
-        if (!particles.empty()) {
-            buildBVH(groups, particles, 0, particles.size());
-        }
-        return groups;
-    }
+   private:
+    UniformGrid grid;
+    std::optional<uint64_t> gridLayout;  // Layout version of the particles the grid was last built over
+    SweepAndPrune sweepAndPrune;
+    KdTree kdTree;
+    Bvh bvh;
+    SweptCollisions sweptCollisions;
+    PairList pairs;
 };
 
-using PhysicsType = unique_ptr<Physics>;
+using PhysicsType = std::unique_ptr<Physics>;
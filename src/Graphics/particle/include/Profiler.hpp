@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fixed size history of samples that writers push into without locking
+// A push claims the next slot with one atomic increment and overwrites the oldest sample, so any number of threads can
+// push. Readers copy out the newest samples while pushes go on, a sample being written at that moment may show up as
+// its old or its new value, which is fine for timings.
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(std::atomic<T>::is_always_lock_free);
+
+   public:
+    void push(T value) {
+        const auto slot = head.fetch_add(1, std::memory_order_relaxed);
+        samples[slot % N].store(value, std::memory_order_relaxed);
+        written.fetch_add(1, std::memory_order_release);
+    }
+
+    // Number of samples held, up to N
+    [[nodiscard]] size_t size() const { return std::min(written.load(std::memory_order_acquire), N); }
+
+    // Copies the held samples oldest first
+    void copyTo(std::vector<T>& out) const {
+        const auto end = written.load(std::memory_order_acquire);
+        const auto count = std::min(end, N);
+        out.resize(count);
+        for (size_t k{}; k < count; k++) out[k] = samples[(end - count + k) % N].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] T last() const {
+        const auto end = written.load(std::memory_order_acquire);
+        return end == 0 ? T{} : samples[(end - 1) % N].load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::array<std::atomic<T>, N> samples{};
+    std::atomic<size_t> head{};
+    std::atomic<size_t> written{};
+};
+
+// Named series of timings in milliseconds, one sample per frame
+// Series are added up front by name and then fed by ScopedTimer or by record with a time measured elsewhere. Only
+// adding series needs to happen on one thread, recording and reading can happen on any.
+class Profiler {
+   public:
+    static constexpr size_t HISTORY{512};  // Samples kept per series
+
+    struct Summary {
+        float last;
+        float mean;
+        float p50;
+        float p95;
+        float p99;
+        float max;
+    };
+
+    // Id of the series with this name, added the first time
+    size_t series(std::string_view name) {
+        for (size_t id{}; id < entries.size(); id++) {
+            if (entries[id]->name == name) return id;
+        }
+        entries.push_back(std::make_unique<Series>(std::string{name}));
+        return entries.size() - 1;
+    }
+
+    void record(size_t id, std::chrono::nanoseconds elapsed) {
+        entries[id]->samples.push(std::chrono::duration<float, std::milli>(elapsed).count());
+    }
+
+    [[nodiscard]] size_t size() const { return entries.size(); }
+    [[nodiscard]] std::string_view name(size_t id) const { return entries[id]->name; }
+    [[nodiscard]] bool empty(size_t id) const { return entries[id]->samples.size() == 0; }
+
+    // Samples of the series oldest first
+    void history(size_t id, std::vector<float>& out) const { entries[id]->samples.copyTo(out); }
+
+    // Statistics over the samples currently held, all zero if there are none
+    [[nodiscard]] Summary summarize(size_t id) {
+        auto& sorted = scratch;
+        history(id, sorted);
+        if (sorted.empty()) return {};
+        const auto last = sorted.back();
+        std::ranges::sort(sorted);
+        float sum{};
+        for (const auto sample : sorted) sum += sample;
+        const auto percentile = [&](double p) {
+            return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5)];
+        };
+        return {last, sum / static_cast<float>(sorted.size()), percentile(0.5), percentile(0.95), percentile(0.99),
+                sorted.back()};
+    }
+
+   private:
+    struct Series {
+        explicit Series(std::string name) : name{std::move(name)} {}
+
+        std::string name;
+        RingBuffer<float, HISTORY> samples;
+    };
+
+    std::vector<std::unique_ptr<Series>> entries;  // Behind pointers as the atomics cannot move
+    std::vector<float> scratch;
+};
+
+// Records the time from construction to destruction into a profiler series, the Stopwatch idea for the profiler
+class ScopedTimer {
+   public:
+    ScopedTimer(Profiler& profiler, size_t id)
+        : profiler{profiler}, id{id}, start{std::chrono::high_resolution_clock::now()} {}
+    ~ScopedTimer() { profiler.record(id, std::chrono::high_resolution_clock::now() - start); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+   private:
+    Profiler& profiler;
+    size_t id;
+    const std::chrono::time_point<std::chrono::high_resolution_clock> start;
+};
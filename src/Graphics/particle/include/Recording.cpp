@@ -0,0 +1,284 @@
+#include "Recording.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+    constexpr std::array<char, 4> MAGIC{'P', 'R', 'E', 'C'};
+    constexpr uint32_t VERSION{1};
+    constexpr uint32_t KEYFRAME{1};
+    constexpr size_t CHANNELS{4};  // x, y, vx, vy
+    // A particle in a keyframe: id, mass, radius, color and the bits of every channel
+    constexpr size_t KEYFRAME_PARTICLE_BYTES{sizeof(uint32_t) + 2 * sizeof(double) + sizeof(Color) +
+                                             CHANNELS * sizeof(uint64_t)};
+
+    struct RecordingHeader {
+        std::array<char, 4> magic;
+        uint32_t version;
+        double quantum;
+    };
+
+    struct FrameHeader {
+        uint32_t payloadBytes;
+        uint32_t count;
+        uint32_t flags;
+        uint32_t reserved;
+        double time;
+    };
+
+    const std::vector<Real>& channel(const ParticleSystem& particles, size_t c) {
+        switch (c) {
+            case 0:
+                return particles.x;
+            case 1:
+                return particles.y;
+            case 2:
+                return particles.vx;
+            default:
+                return particles.vy;
+        }
+    }
+
+    uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+    int64_t unzigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+    void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Returns false when the varint runs past end or is longer than 64 bits
+    bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (unsigned shift{}; in < end && shift < 64; shift += 7) {
+            const auto byte = *in++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) return true;
+        }
+        return false;
+    }
+
+    template <typename T>
+    void putRaw(std::vector<uint8_t>& out, const std::vector<T>& values) {
+        const auto offset = out.size();
+        out.resize(offset + values.size() * sizeof(T));
+        if (!values.empty()) std::memcpy(out.data() + offset, values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void getRaw(const uint8_t*& in, std::vector<T>& values, size_t count) {
+        values.resize(count);
+        if (count > 0) std::memcpy(values.data(), in, count * sizeof(T));
+        in += count * sizeof(T);
+    }
+
+}  // namespace
+
+Recorder::Recorder(const std::string& path, RecordingOptions options)
+    : out{path, std::ios::binary | std::ios::trunc}, options{options} {
+    if (!out) throw std::runtime_error("Cannot create recording " + path);
+    this->options.quantum = std::max(options.quantum, 0.0);
+    this->options.keyframeInterval = std::max<uint32_t>(options.keyframeInterval, 1);
+    const RecordingHeader header{MAGIC, VERSION, this->options.quantum};
+    write(&header, sizeof(header));
+}
+
+void Recorder::record(const ParticleSystem& particles, double time) {
+    if (!out.is_open()) return;
+    payload.clear();
+    const bool keyframe = frameCount == 0 || sinceKeyframe + 1 >= options.keyframeInterval || !sameParticles(particles);
+    if (keyframe) {
+        encodeKeyframe(particles);
+        sinceKeyframe = 0;
+    } else {
+        encodeDelta(particles);
+        sinceKeyframe++;
+    }
+
+    const FrameHeader header{static_cast<uint32_t>(payload.size()), static_cast<uint32_t>(particles.size()),
+                             keyframe ? KEYFRAME : 0, 0, time};
+    write(&header, sizeof(header));
+    write(payload.data(), payload.size());
+    frameCount++;
+}
+
+void Recorder::close() {
+    if (out.is_open()) out.close();
+}
+
+bool Recorder::sameParticles(const ParticleSystem& particles) const {
+    const auto n = particles.size();
+    if (n != ids.size()) return false;
+    for (size_t i{}; i < n; i++) {
+        if (particles.handleAt(i).id != ids[i]) return false;
+    }
+    return std::ranges::equal(particles.mass, mass) && std::ranges::equal(particles.radius, radius) &&
+           std::ranges::equal(particles.color, color, [](Color a, Color b) {
+               return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+           });
+}
+
+void Recorder::encodeKeyframe(const ParticleSystem& particles) {
+    const auto n = particles.size();
+    ids.resize(n);
+    for (size_t i{}; i < n; i++) ids[i] = particles.handleAt(i).id;
+    mass.assign(particles.mass.begin(), particles.mass.end());
+    radius.assign(particles.radius.begin(), particles.radius.end());
+    color = particles.color;
+    putRaw(payload, ids);
+    putRaw(payload, mass);
+    putRaw(payload, radius);
+    putRaw(payload, color);
+
+    for (size_t c{}; c < CHANNELS; c++) {
+        const auto& values = channel(particles, c);
+        auto& bits = motion[c];
+        bits.resize(n);
+        for (size_t i{}; i < n; i++) {
+            bits[i] = options.quantum > 0 ? static_cast<uint64_t>(std::llround(values[i] / options.quantum))
+                                          : std::bit_cast<uint64_t>(static_cast<double>(values[i]));
+        }
+        putRaw(payload, bits);
+    }
+}
+
+void Recorder::encodeDelta(const ParticleSystem& particles) {
+    // Channel by channel so the varints of one quantity sit together
+    for (size_t c{}; c < CHANNELS; c++) {
+        const auto& values = channel(particles, c);
+        auto& bits = motion[c];
+        for (size_t i{}; i < values.size(); i++) {
+            if (options.quantum > 0) {
+                const auto q = std::llround(values[i] / options.quantum);
+                putVarint(payload, zigzag(q - static_cast<int64_t>(bits[i])));
+                bits[i] = static_cast<uint64_t>(q);
+            } else {
+                const auto raw = std::bit_cast<uint64_t>(static_cast<double>(values[i]));
+                putVarint(payload, raw ^ bits[i]);
+                bits[i] = raw;
+            }
+        }
+    }
+}
+
+void Recorder::write(const void* data, size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    bytesWritten += size;
+}
+
+Player::Player(const std::string& path) {
+    const auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open recording " + path);
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(RecordingHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a recording " + path);
+    }
+    fileSize = static_cast<size_t>(info.st_size);
+    auto* mapped = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Cannot map recording " + path);
+    data = static_cast<const uint8_t*>(mapped);
+    // Frames are read front to back
+    ::madvise(mapped, fileSize, MADV_SEQUENTIAL);
+
+    RecordingHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION) {
+        ::munmap(mapped, fileSize);
+        throw std::runtime_error("Not a recording " + path);
+    }
+    quantum = header.quantum;
+
+    size_t offset{sizeof(RecordingHeader)};
+    size_t keyframe{};
+    while (offset + sizeof(FrameHeader) <= fileSize) {
+        FrameHeader frame{};
+        std::memcpy(&frame, data + offset, sizeof(frame));
+        const auto payloadOffset = offset + sizeof(FrameHeader);
+        if (payloadOffset + frame.payloadBytes > fileSize) break;
+        const bool isKeyframe = (frame.flags & KEYFRAME) != 0;
+        // A recording always starts with a keyframe, anything else is not one we wrote
+        if (frames.empty() && !isKeyframe) break;
+        // Keyframes hold every particle in full, delta frames the changes to the particles of their keyframe
+        if (isKeyframe && frame.payloadBytes < frame.count * KEYFRAME_PARTICLE_BYTES) break;
+        if (!isKeyframe && frame.count != frames[keyframe].count) break;
+        if (isKeyframe) keyframe = frames.size();
+        frames.push_back({payloadOffset, frame.payloadBytes, frame.count, keyframe, frame.time, isKeyframe});
+        offset = payloadOffset + frame.payloadBytes;
+    }
+    if (!frames.empty()) decode(0);
+}
+
+Player::~Player() {
+    if (data) ::munmap(const_cast<uint8_t*>(data), fileSize);
+}
+
+void Player::seek(size_t frame) {
+    if (frames.empty()) return;
+    frame = std::min(frame, frames.size() - 1);
+    if (decoded && frame == current) return;
+
+    auto from = frames[frame].keyframe;
+    if (decoded && current < frame && current >= from) from = current + 1;
+    for (auto f = from; f <= frame; f++) decode(f);
+}
+
+void Player::decode(size_t frame) {
+    const auto& info = frames[frame];
+    const auto* in = data + info.offset;
+    const auto n = info.count;
+
+    if (info.isKeyframe) {
+        getRaw(in, ids, n);
+        getRaw(in, mass, n);
+        getRaw(in, radius, n);
+        getRaw(in, color, n);
+        for (auto& bits : motion) getRaw(in, bits, n);
+    } else {
+        // A frame that ends early leaves the rest of its particles where the frame before had them
+        const auto* end = in + info.bytes;
+        for (auto& bits : motion) {
+            for (size_t i{}; i < n; i++) {
+                uint64_t code{};
+                if (!getVarint(in, end, code)) break;
+                bits[i] = quantum > 0 ? static_cast<uint64_t>(static_cast<int64_t>(bits[i]) + unzigzag(code))
+                                      : bits[i] ^ code;
+            }
+        }
+    }
+
+    const std::array<std::vector<double>*, CHANNELS> channels{&x, &y, &vx, &vy};
+    for (size_t c{}; c < CHANNELS; c++) {
+        const auto& bits = motion[c];
+        auto& values = *channels[c];
+        values.resize(n);
+        for (size_t i{}; i < n; i++) {
+            values[i] = quantum > 0 ? static_cast<double>(static_cast<int64_t>(bits[i])) * quantum
+                                    : std::bit_cast<double>(bits[i]);
+        }
+    }
+    current = frame;
+    decoded = true;
+}
+
+void Player::copyTo(ParticleSystem& particles) const {
+    particles.clear();
+    particles.reserve(size());
+    for (size_t i{}; i < size(); i++) {
+        particles.add(x[i], y[i], vx[i], vy[i], mass[i], color[i]);
+        particles.radius[i] = radius[i];
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+
+// Binary capture of a simulation run, one frame per step
+// A frame is either a keyframe holding every particle in full or a delta against the frame before it holding only
+// positions and velocities. Deltas are written as variable length integers, of the XOR of the double bits when
+// recording exactly and of the difference of the values rounded to a multiple of the quantum when quantized. Anything
+// other than motion changing, particles added, removed or recolored, makes the next frame a keyframe, as does every
+// keyframeInterval-th frame so the player can seek without decoding from the start.
+//
+// Layout: RecordingHeader, then per frame a FrameHeader followed by payloadBytes of payload. Keyframe payload is the
+// handle ids, masses, radii, colors and then x, y, vx and vy as raw 64 bit values. Delta payload is x, y, vx and vy
+// as varints. Values are little endian, the byte order of every machine this runs on. Values are stored as doubles
+// whatever the precision of the particles, so recordings play in either build and float ones still record exactly.
+
+struct RecordingOptions {
+    double quantum{};               // Resolution of positions and velocities, 0 records the doubles exactly
+    uint32_t keyframeInterval{60};  // Most frames between keyframes
+};
+
+class Recorder {
+   public:
+    // Throws std::runtime_error if the file cannot be created
+    explicit Recorder(const std::string& path, RecordingOptions options = {});
+    ~Recorder() { close(); }
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Appends the current state as the frame at simulated time
+    void record(const ParticleSystem& particles, double time);
+    void close();
+
+    [[nodiscard]] size_t getFrameCount() const { return frameCount; }
+    [[nodiscard]] size_t getBytesWritten() const { return bytesWritten; }
+
+   private:
+    // Whether only the motion changed since the last frame
+    [[nodiscard]] bool sameParticles(const ParticleSystem& particles) const;
+    void encodeKeyframe(const ParticleSystem& particles);
+    void encodeDelta(const ParticleSystem& particles);
+    void write(const void* data, size_t size);
+
+    std::ofstream out;
+    RecordingOptions options;
+    std::vector<uint8_t> payload;
+    size_t frameCount{};
+    size_t bytesWritten{};
+    size_t sinceKeyframe{};
+
+    // Last frame written, motion as raw or quantized bits depending on the options
+    std::vector<uint32_t> ids;
+    std::vector<double> mass;
+    std::vector<double> radius;
+    std::vector<Color> color;
+    std::array<std::vector<uint64_t>, 4> motion;
+};
+
+// Replays a recording from a memory mapped file
+// Frames are found by one scan of the frame headers when the file is opened, a recording cut short by a crash or
+// with a frame that does not fit its keyframe plays up to the last good frame before it. The decoded state of the
+// current frame is exposed the same way ParticleSystem exposes its arrays.
+class Player {
+   public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a recording
+    explicit Player(const std::string& path);
+    ~Player();
+    Player(const Player&) = delete;
+    Player& operator=(const Player&) = delete;
+
+    [[nodiscard]] size_t getFrameCount() const { return frames.size(); }
+    [[nodiscard]] size_t getFrame() const { return current; }
+    [[nodiscard]] double getTime(size_t frame) const { return frames[frame].time; }
+    [[nodiscard]] double getQuantum() const { return quantum; }
+
+    // Decodes a frame, forward from the current frame when it is ahead of it and otherwise from the last keyframe
+    // at or before it
+    void seek(size_t frame);
+
+    // Replaces the particles with the ones in the current frame
+    void copyTo(ParticleSystem& particles) const;
+
+    [[nodiscard]] size_t size() const { return ids.size(); }
+
+    std::vector<uint32_t> ids;  // Handle ids at record time, they tell particles apart across frames
+    std::vector<double> mass;
+    std::vector<double> radius;
+    std::vector<Color> color;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> vx;
+    std::vector<double> vy;
+
+   private:
+    struct FrameInfo {
+        size_t offset;  // Of the payload
+        size_t bytes;
+        size_t count;
+        size_t keyframe;  // Last keyframe at or before this frame
+        double time;
+        bool isKeyframe;
+    };
+
+    void decode(size_t frame);
+
+    const uint8_t* data{};
+    size_t fileSize{};
+    double quantum{};
+    std::vector<FrameInfo> frames;
+    size_t current{};
+    bool decoded{false};
+    std::array<std::vector<uint64_t>, 4> motion;
+};
@@ -14,8 +14,11 @@ ScreenPtr& Screen::Instance() {
     return instance;
 }
 
-bool Screen::init(const std::string& title, Vector2<int> dim, bool fullscreen, double dt, uint framerate) {
+bool Screen::init(const std::string& title, Vector2<int> dim, bool fullscreen, int substeps, uint framerate) {
     win->setFramerateLimit(framerate);
+    this->framerate = framerate;
+    this->substeps = std::max(substeps, 1);
+    configureTimestep();
     this->title = title;
     this->fullscreen = fullscreen;
     this->dim.at(0) = dim.at(0);
@@ -30,9 +33,11 @@ bool Screen::init(const std::string& title, Vector2<int> dim, bool fullscreen, d
     border.setPosition(borderXMin, borderYMin);
     border.setOrigin(borderXMin, borderYMin);
     border.setSize({borderXMax, borderYMax});
-    // for (int i{}; i < 10; i++) addRandomParticle();
+    selectionBox.setFillColor({0x00, 0x00, 0xFF, 0x20});
+    selectionBox.setOutlineThickness(1);
+    selectionBox.setOutlineColor(sf::Color::Blue);
     physics->setWinDim(borderXMin, borderXMax, borderYMin, borderYMax);
-    physics->dt = dt;
+    world.autoBroadPhase = true;
     create();
     running = true;
     cout << std::format("Created window with FPS: {} and Dimensions:\n{}", framerate, std::string{dim});
@@ -59,31 +64,51 @@ void Screen::toggleFullscreen() {
     create();
 }
 
-void Screen::cullOutOfBoundsParticles() {
-    if (!cull) return;
-    for (auto it = particles.begin(); it != particles.end();) {
-        const auto& part = *it;
-        const auto& pos = part->gPos();
-        if (pos.at(0) > borderXMax + part->gRadius() + 10 || pos.at(0) + part->gRadius() + 10 < borderXMin ||
-            pos.at(1) > borderYMax + part->gRadius() + 10 || pos.at(1) + part->gRadius() + 10 < borderYMin) {
-            removeParticle(it);
-        } else {
-            ++it;
-        }
-    }
+void Screen::configureTimestep() {
+    timestep.setStep(1.0 / (framerate * substeps));
+    timestep.setMaxSteps(static_cast<size_t>(substeps) * MAX_CATCH_UP_FRAMES);
 }
 
 void Screen::update() {
-    for (auto& part : particles) {
-        physics->handleBoxCollision(part);
-
-        part->update(physics->dt);
+    if (player) {
+        updateReplay();
+        return;
     }
-    physics->handleParticleCollision();
-
-    for (auto& spring : springs) spring->update();
 
-    cullOutOfBoundsParticles();
+    // Real time since the last frame is run as whole fixed steps, leftover time carries over to the next frame
+    physics->dt = timestep.getStep() * timeScale;
+    const auto steps = timestep.advance(elapsed.asSeconds());
+    PhaseTimes frameTimes;
+    // With the broad-phase picked automatically one frame can run several methods
+    std::array<std::chrono::nanoseconds, COLLISION_METHOD_COUNT> broadPhaseTimes{};
+    for (size_t step{}; step < steps; step++) {
+        if (streaming) spawner.stream(particles, emitter, physics->dt, spawnAttributes);
+        const auto method = static_cast<size_t>(physics->collisionMethod);
+        world.step();
+        simTime += physics->dt;
+        if (recorder) recorder->record(particles, simTime);
+
+        const auto& times = world.getPhaseTimes();
+        frameTimes.integrate += times.integrate;
+        broadPhaseTimes[method] += times.broadPhase;
+        frameTimes.narrowPhase += times.narrowPhase;
+        frameTimes.constraints += times.constraints;
+        frameTimes.sleep += times.sleep;
+        frameTimes.cull += times.cull;
+    }
+    profiler.record(profileSeries.frame, std::chrono::microseconds{elapsed.asMicroseconds()});
+    if (steps > 0) {
+        profiler.record(profileSeries.integrate, frameTimes.integrate);
+        for (size_t method{}; method < COLLISION_METHOD_COUNT; method++) {
+            if (broadPhaseTimes[method].count() > 0)
+                profiler.record(profileSeries.broadPhase[method], broadPhaseTimes[method]);
+        }
+        profiler.record(profileSeries.narrowPhase, frameTimes.narrowPhase);
+        profiler.record(profileSeries.constraints, frameTimes.constraints);
+        profiler.record(profileSeries.sleep, frameTimes.sleep);
+        profiler.record(profileSeries.cull, frameTimes.cull);
+    }
+    logBroadPhaseDecisions();
 
     const auto& [x, y] = win->getSize();
     dim.at(0) = (int)x - 10;
@@ -92,81 +117,349 @@ void Screen::update() {
         borderXMax = dim.at(0);
         borderYMax = dim.at(1);
         border.setSize({borderXMax, borderYMax});
-        physics->setWinDim(borderXMin, borderXMax, borderYMin, borderYMax);
     }
+    physics->setWinDim(borderXMin, borderXMax, borderYMin, borderYMax);
 }
 
-void Screen::addRandomParticle() {
-    std::default_random_engine rng{std::random_device{}()};
-    std::uniform_real_distribution<double> rngX{0, (double)dim.at(0)};
-    std::uniform_real_distribution<double> rngY{0, (double)dim.at(1)};
-    std::uniform_int_distribution<int> rngMass{2, 10};
-    std::uniform_real_distribution<double> rngVel{-20, 100};
-    std::uniform_int_distribution<int> rngColor{0, 255};
-
-    double x = rngX(rng);
-    double y = rngY(rng);
-    double velX = rngVel(rng);
-    double velY = rngVel(rng);
-    int mass = rngMass(rng);
-    sf::Color color = {static_cast<uint8_t>(rngColor(rng)), static_cast<uint8_t>(rngColor(rng)),
-                       static_cast<uint8_t>(rngColor(rng)), 255};
-    addParticle({x, y}, {velX, velY}, mass, color);
+void Screen::logBroadPhaseDecisions() {
+    const auto& selector = world.getBroadPhaseSelector();
+    const auto& decisions = selector.getDecisions();
+    const auto fresh = std::min(selector.getDecisionCount() - loggedDecisions, decisions.size());
+    for (auto k = decisions.size() - fresh; k < decisions.size(); k++) {
+        const auto& decision = decisions[k];
+        cout << std::format("Broad-phase switched from {} at {:.3f} ms to {} at {:.3f} ms per step, step {}\n",
+                            parseCollisionMethods(decision.from), decision.fromCost,
+                            parseCollisionMethods(decision.to), decision.toCost, decision.step);
+    }
+    loggedDecisions = selector.getDecisionCount();
 }
 
-void Screen::addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass) {
-    particles.emplace_back(std::make_unique<Particle>(pos, vel, mass, physics->gravity));
-    numParticles++;
+void Screen::updateReplay() {
+    // Frames are shown at the simulated time they were recorded at, scaled by the replay speed
+    if (!replayPaused) replayTime += elapsed.asSeconds() * replaySpeed;
+    auto frame = player->getFrame();
+    const auto start = player->getTime(0);
+    while (frame + 1 < player->getFrameCount() && player->getTime(frame + 1) - start <= replayTime) frame++;
+    showReplayFrame(frame);
 }
 
-void Screen::addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass, sf::Color color) {
-    particles.emplace_back(std::make_unique<Particle>(pos, vel, mass, physics->gravity, color));
-    numParticles++;
+void Screen::showReplayFrame(size_t frame) {
+    player->seek(frame);
+    player->copyTo(replayParticles);
+    replayTime = player->getTime(frame) - player->getTime(0);
 }
 
-void Screen::removeParticle(const PartPtr& particle) {
-    auto res = std::remove(particles.begin(), particles.end(), particle);
-    numParticles--;
+void Screen::startRecording() {
+    try {
+        recorder = std::make_unique<Recorder>(recordingPath, RecordingOptions{.quantum = recordingQuantum});
+        recordingStatus = std::format("Recording to {}", recordingPath);
+    } catch (const std::runtime_error& e) {
+        recordingStatus = e.what();
+    }
 }
 
-void Screen::selectParticle(PartPtr& selection, const Callback& endCallback) {
-    const int slack = 3;
-    auto mPos = sf::Mouse::getPosition(*win);
-    for (const auto& particle : particles) {
-        const auto radius = particle->gRadius();
-        const auto pos = particle->gPos();
-        if (pos.at(0) - radius <= mPos.x + slack && mPos.x - slack <= pos.at(0) + radius &&
-            pos.at(1) - radius <= mPos.y + slack && mPos.y - slack <= pos.at(1) + radius) {
-            selection = particle;
-            // selection->gCircle().setOutlineColor(sf::Color::Red);
-            // selection->gCircle().setOutlineThickness(5);
-            selection->outlineThickness = 5;
+void Screen::stopRecording() {
+    recordingStatus = std::format("Recorded {} frames, {:.1f} MB", recorder->getFrameCount(),
+                                  static_cast<double>(recorder->getBytesWritten()) / (1 << 20));
+    recorder.reset();
+}
 
+void Screen::openReplay() {
+    try {
+        player = std::make_unique<Player>(recordingPath);
+        recordingStatus = std::format("Replaying {} frames from {}", player->getFrameCount(), recordingPath);
+        if (player->getFrameCount() == 0) {
+            player.reset();
             return;
         }
+        replayPaused = false;
+        showReplayFrame(0);
+    } catch (const std::runtime_error& e) {
+        recordingStatus = e.what();
+    }
+}
+
+void Screen::renderRecordingUI() {
+    ImGui::Begin("Recording");
+    ImGui::InputText("File", recordingPath, sizeof(recordingPath));
+    if (!recorder && !player) {
+        ImGui::InputDouble("Quantum", &recordingQuantum, 0.001, 0.01, "%.4f");
+        recordingQuantum = std::max(recordingQuantum, 0.0);
+        if (ImGui::Button("Start Recording")) startRecording();
+        if (ImGui::Button("Open Replay")) openReplay();
+    } else if (recorder) {
+        ImGui::Text("Frames: %zu", recorder->getFrameCount());
+        if (ImGui::Button("Stop Recording")) stopRecording();
+    } else {
+        int frame = static_cast<int>(player->getFrame());
+        if (ImGui::SliderInt("Frame", &frame, 0, static_cast<int>(player->getFrameCount()) - 1))
+            showReplayFrame(static_cast<size_t>(frame));
+        ImGui::InputDouble("Replay Speed", &replaySpeed, 0.25, 1.0, "%.2f");
+        replaySpeed = std::max(replaySpeed, 0.0);
+        ImGui::Checkbox("Pause", &replayPaused);
+        if (ImGui::Button("Close Replay")) player.reset();
+    }
+    ImGui::TextUnformatted(recordingStatus.c_str());
+    ImGui::End();
+}
+
+void Screen::spawn(SpawnPattern pattern, sf::Vector2i at) {
+    const auto count = static_cast<size_t>(std::max(spawnCount, 0));
+    const Vec2d position{static_cast<double>(at.x), static_cast<double>(at.y)};
+    switch (pattern) {
+        case SpawnPattern::SCATTER:
+            spawner.scatter(particles, count, {borderXMin, borderYMin}, {borderXMax, borderYMax}, spawnAttributes);
+            break;
+        case SpawnPattern::BURST:
+            spawner.burst(particles, count, position, burstRadius, spawnAttributes);
+            break;
+        case SpawnPattern::LATTICE:
+            spawner.lattice(particles, static_cast<size_t>(std::max(latticeColumns, 0)),
+                            static_cast<size_t>(std::max(latticeRows, 0)), position, latticeSpacing, {},
+                            spawnAttributes);
+            break;
+    }
+}
+
+void Screen::renderSpawnerUI() {
+    ImGui::Begin("Spawner");
+    static constexpr std::array patterns{"Scatter", "Burst", "Lattice"};
+    ImGui::Combo("Pattern", &spawnPattern, patterns.data(), patterns.size());
+    const auto pattern = static_cast<SpawnPattern>(spawnPattern);
+    if (pattern == SpawnPattern::LATTICE) {
+        ImGui::InputInt("Columns", &latticeColumns, 10, 100);
+        ImGui::InputInt("Rows", &latticeRows, 10, 100);
+        ImGui::SliderFloat("Spacing", &latticeSpacing, 1, 50);
+    } else {
+        ImGui::InputInt("Count", &spawnCount, 10, 1000);
+    }
+    if (pattern == SpawnPattern::BURST) ImGui::SliderFloat("Burst Radius", &burstRadius, 0, 500);
+    // Burst and lattice start from the middle of the border
+    if (ImGui::Button("Spawn")) {
+        spawn(pattern,
+              {static_cast<int>((borderXMin + borderXMax) / 2), static_cast<int>((borderYMin + borderYMax) / 2)});
+    }
+    ImGui::Text("Particles: %zu", particles.size());
+
+    ImGui::Separator();
+    ImGui::InputInt("Min Mass", &spawnAttributes.minMass);
+    ImGui::InputInt("Max Mass", &spawnAttributes.maxMass);
+    spawnAttributes.minMass = std::max(spawnAttributes.minMass, 1);
+    spawnAttributes.maxMass = std::max(spawnAttributes.maxMass, spawnAttributes.minMass);
+    ImGui::InputDouble("Min Speed", &spawnAttributes.minSpeed, 1, 10, "%.1f");
+    ImGui::InputDouble("Max Speed", &spawnAttributes.maxSpeed, 1, 10, "%.1f");
+    spawnAttributes.maxSpeed = std::max(spawnAttributes.maxSpeed, spawnAttributes.minSpeed);
+    ImGui::Checkbox("Random Color", &spawnAttributes.randomColor);
+    // Otherwise the color picked for placed particles
+    spawnAttributes.color = {newParticleColor.r, newParticleColor.g, newParticleColor.b, newParticleColor.a};
+
+    ImGui::Separator();
+    ImGui::Checkbox("Streaming", &streaming);
+    ImGui::InputDouble("Position X", &emitter.position.x, 1, 10, "%.0f");
+    ImGui::InputDouble("Position Y", &emitter.position.y, 1, 10, "%.0f");
+    float angle = static_cast<float>(std::atan2(emitter.direction.y, emitter.direction.x));
+    if (ImGui::SliderAngle("Direction", &angle)) emitter.direction = {std::cos(angle), std::sin(angle)};
+    float spread = static_cast<float>(emitter.spread);
+    if (ImGui::SliderAngle("Spread", &spread, 0, 180)) emitter.spread = spread;
+    ImGui::InputDouble("Rate", &emitter.rate, 10, 1000, "%.0f/s");
+    emitter.rate = std::max(emitter.rate, 0.0);
+    ImGui::End();
+}
+
+ParticleHandle Screen::addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass) {
+    return particles.add(pos.at(0), pos.at(1), vel.at(0), vel.at(1), mass);
+}
+
+ParticleHandle Screen::addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass,
+                                   sf::Color color) {
+    return particles.add(pos.at(0), pos.at(1), vel.at(0), vel.at(1), mass, {color.r, color.g, color.b, color.a});
+}
+
+void Screen::removeParticle(ParticleHandle particle) { world.removeParticle(particle); }
+
+void Screen::addSpringBetweenParticles(ParticleHandle p1, ParticleHandle p2) {
+    world.addSpring(p1, p2, springRestLength, springCompliance);
+}
+
+void Screen::selectParticle(ParticleHandle& selection, const Callback& endCallback) {
+    const double slack = 3;
+    const auto mPos = sf::Mouse::getPosition(*win);
+    if (const auto i = world.pickAt(mPos.x, mPos.y, slack); i != ParticleSystem::NPOS)
+        selection = particles.handleAt(i);
+    else
         endCallback(selection);
+}
+
+void Screen::addToSelection(const std::vector<size_t>& indices) {
+    for (const auto i : indices) selectedParticles.push_back(particles.handleAt(i));
+    std::ranges::sort(selectedParticles, {}, &ParticleHandle::id);
+    const auto [first, last] = std::ranges::unique(selectedParticles);
+    selectedParticles.erase(first, last);
+}
+
+void Screen::selectRect(sf::Vector2i from, sf::Vector2i to) {
+    queryResult.clear();
+    world.queryRect(from.x, from.y, to.x, to.y, queryResult);
+    addToSelection(queryResult);
+}
+
+void Screen::selectCircle(sf::Vector2i center) {
+    queryResult.clear();
+    world.queryCircle(center.x, center.y, brushRadius, queryResult);
+    addToSelection(queryResult);
+}
+
+const std::vector<size_t>& Screen::highlightedParticles() {
+    highlighted.clear();
+    for (const auto handle : {selectedParticle, firstSpringParticle, secondSpringParticle}) {
+        const auto i = particles.indexOf(handle);
+        if (i != ParticleSystem::NPOS && std::ranges::find(highlighted, i) == highlighted.end())
+            highlighted.push_back(i);
+    }
+    // Handles in the selection are unique so their slots are too
+    for (const auto handle : selectedParticles) {
+        const auto i = particles.indexOf(handle);
+        if (i != ParticleSystem::NPOS && handle != selectedParticle) highlighted.push_back(i);
+    }
+    return highlighted;
+}
+
+void Screen::renderProfilerUI() {
+    ImGui::Begin("Profiler");
+    ImGui::Text("Particles: %zu, last %zu frames, times in ms", particles.size(), Profiler::HISTORY);
+    if (ImGui::BeginTable("Phases", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        for (const auto* column : {"Phase", "Last", "Mean", "p50", "p95", "p99", "Max"}) {
+            ImGui::TableSetupColumn(column);
+        }
+        ImGui::TableHeadersRow();
+        for (size_t id{}; id < profiler.size(); id++) {
+            // Broad-phase methods that have not run yet would only add empty rows
+            if (profiler.empty(id)) continue;
+            const auto [last, mean, p50, p95, p99, max] = profiler.summarize(id);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(profiler.name(id).data());
+            for (const auto value : {last, mean, p50, p95, p99, max}) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", value);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::CollapsingHeader("Graphs")) {
+        for (size_t id{}; id < profiler.size(); id++) {
+            if (profiler.empty(id)) continue;
+            profiler.history(id, profileHistory);
+            const auto peak = *std::ranges::max_element(profileHistory);
+            ImGui::PlotLines(profiler.name(id).data(), profileHistory.data(), static_cast<int>(profileHistory.size()),
+                             0, nullptr, 0, peak, {0, 60});
+        }
+    }
+    ImGui::End();
+}
+
+void Screen::renderBroadPhaseUI() {
+    const auto& selector = world.getBroadPhaseSelector();
+    ImGui::Text("Using: %s%s", parseCollisionMethods(selector.getCurrent()).c_str(),
+                selector.isProbing() ? " (probing)" : "");
+    // Broad and narrow phase per step of every method in the last probe
+    if (ImGui::BeginTable("Broad-phase Probes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        for (const auto* column : {"Method", "ms/step", "Pairs"}) {
+            ImGui::TableSetupColumn(column);
+        }
+        ImGui::TableHeadersRow();
+        const auto& probes = selector.getProbes();
+        for (size_t method{}; method < COLLISION_METHOD_COUNT; method++) {
+            if (!probes[method].measured) continue;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(parseCollisionMethods(static_cast<CollisionDetection>(method)).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", probes[method].cost);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", probes[method].pairs);
+        }
+        ImGui::EndTable();
+    }
+    if (const auto& decisions = selector.getDecisions(); !decisions.empty()) {
+        const auto& last = decisions.back();
+        ImGui::Text("Last switch at step %zu: %s -> %s", last.step, parseCollisionMethods(last.from).c_str(),
+                    parseCollisionMethods(last.to).c_str());
     }
 }
 
 void Screen::renderUI() {
+    renderRecordingUI();
+    renderProfilerUI();
+    renderSpawnerUI();
+
     ImGui::Begin("Selected Particle");
-    if (!selectedParticle)
+    if (const auto i = particles.indexOf(selectedParticle); i == ParticleSystem::NPOS)
         ImGui::Text("No Selected Particle");
     else {
-        ImGui::Text("Velocity: (%.2f, %.2f)", selectedParticle->gVel().at(0), selectedParticle->gVel().at(1));
-        ImGui::Text("Position: (%.2f, %.2f)", selectedParticle->gPos().at(0), selectedParticle->gPos().at(1));
-        ImGui::Text("Mass: %d", selectedParticle->gMass());
-        ImGui::Text("Radius: %.2f", selectedParticle->gRadius());
+        ImGui::Text("Velocity: (%.2f, %.2f)", particles.vx[i], particles.vy[i]);
+        ImGui::Text("Position: (%.2f, %.2f)", particles.x[i], particles.y[i]);
+        ImGui::Text("Mass: %.2f", particles.mass[i]);
+        ImGui::Text("Radius: %.2f", particles.radius[i]);
     }
     ImGui::End();
 
+    ImGui::Begin("Selection");
+    std::erase_if(selectedParticles, [this](ParticleHandle handle) { return !particles.contains(handle); });
+    ImGui::Text("Selected: %zu", selectedParticles.size());
+    ImGui::Text("Shift + drag to box select, Control + drag to brush select");
+    ImGui::SliderFloat("Brush Radius", &brushRadius, 5, 200);
+    if (ImGui::Button("Apply Color")) {
+        for (const auto handle : selectedParticles) {
+            particles.color[particles.indexOf(handle)] = {newParticleColor.r, newParticleColor.g, newParticleColor.b,
+                                                          newParticleColor.a};
+        }
+    }
+    if (ImGui::Button("Apply Velocity")) {
+        for (const auto handle : selectedParticles) {
+            const auto i = particles.indexOf(handle);
+            world.wake(i);
+            particles.vx[i] = newParticleVel.at(0);
+            particles.vy[i] = newParticleVel.at(1);
+        }
+    }
+    if (ImGui::Button("Delete Selected")) {
+        for (const auto handle : selectedParticles) particles.markDead(handle);
+        world.compact();
+        selectedParticles.clear();
+    }
+    if (ImGui::Button("Clear Selection")) selectedParticles.clear();
+    ImGui::End();
+
     ImGui::Begin("Particles");
-    ImGui::Text("Particles: %zu", numParticles);
+    ImGui::Text("Particles: %zu", particles.size());
     ImGui::Text("dt: %f", physics->dt);
+    ImGui::Text("Steps This Frame: %zu", timestep.getLastSteps());
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
-    ImGui::InputDouble("dt", &(physics->dt), physics->dt, 0.1, "%.2f");
+    ImGui::Text("Candidate Pairs: %zu", physics->collisionStats.candidates);
+    ImGui::Text("Collisions: %zu (%.1f%% hit rate)", physics->collisionStats.hits,
+                physics->collisionStats.hitRate() * 100);
+    if (physics->continuous)
+        ImGui::Text("Swept: %zu (%zu contacts)", physics->collisionStats.swept, physics->collisionStats.sweptHits);
+    ImGui::InputDouble("Time Scale", &timeScale, TIME_SCALE_STEP, 1.0, "%.2f");
+    timeScale = std::clamp(timeScale, 0.0, MAX_TIME_SCALE);
+    if (ImGui::InputInt("Substeps", &substeps)) {
+        substeps = std::max(substeps, 1);
+        configureTimestep();
+    }
 
-    ImGui::Checkbox("Cull Out of Bounds particles", &cull);
+    ImGui::Checkbox("Cull Out of Bounds particles", &world.cull);
+
+    ImGui::Checkbox("Sleep Resting Particles", &world.sleeping.enabled);
+    if (world.sleeping.enabled) {
+        ImGui::InputDouble("Rest Speed", &world.sleeping.restSpeed, 0.5, 5.0, "%.1f");
+        world.sleeping.restSpeed = std::max(world.sleeping.restSpeed, 0.0);
+        int restFrames = world.sleeping.restFrames;
+        if (ImGui::InputInt("Rest Frames", &restFrames))
+            world.sleeping.restFrames = static_cast<uint16_t>(std::clamp(restFrames, 1, 1000));
+    }
+    ImGui::Text("Sleeping: %zu", particles.getSleepingCount());
 
     if (ImGui::Checkbox("Place Mode", &placeMode)) {
         springMode = false;
@@ -174,10 +467,11 @@ void Screen::renderUI() {
 
     // Collision Detection Method
     std::vector<std::string> methodStrings;
-    methodStrings.reserve(4);
-    for (int i = 0; i < 4; i++) {
+    methodStrings.reserve(COLLISION_METHOD_COUNT);
+    for (int i = 0; i < COLLISION_METHOD_COUNT; i++) {
         methodStrings.push_back(parseCollisionMethods(static_cast<CollisionDetection>(i)));
     }
+    methodStrings.emplace_back("Auto");  // Last item, after every method
 
     // Convert to vector of const char* for ImGui
     std::vector<const char*> items;
@@ -186,9 +480,19 @@ void Screen::renderUI() {
         items.push_back(str.c_str());
     }
 
-    int currentItem = static_cast<int>(physics->collisionMethod);
+    int currentItem = world.autoBroadPhase ? COLLISION_METHOD_COUNT : static_cast<int>(physics->collisionMethod);
     if (ImGui::Combo("Collision Method", &currentItem, items.data(), items.size())) {
-        physics->collisionMethod = static_cast<CollisionDetection>(currentItem);
+        world.autoBroadPhase = currentItem == COLLISION_METHOD_COUNT;
+        if (!world.autoBroadPhase) physics->collisionMethod = static_cast<CollisionDetection>(currentItem);
+    }
+    if (world.autoBroadPhase) renderBroadPhaseUI();
+
+    ImGui::Checkbox("Continuous Collisions", &(physics->continuous));
+    ImGui::Checkbox("Parallel Step", &(physics->parallel));
+    if (physics->parallel) {
+        int threads = static_cast<int>(physics->parallelStep.getThreads());
+        if (ImGui::InputInt("Threads", &threads) && threads > 0)
+            physics->parallelStep.setThreads(static_cast<size_t>(threads));
     }
 
     // Border Control
@@ -208,13 +512,23 @@ void Screen::renderUI() {
         placeMode = false;
         precisionPlacement = false;
     }
+    if (springMode) {
+        ImGui::InputDouble("Spring Rest Length", &springRestLength, 1.0, 10.0, "%.1f");
+        ImGui::InputDouble("Spring Compliance", &springCompliance, 0.001, 0.01, "%.4f");
+        springRestLength = std::max(springRestLength, 0.0);
+        springCompliance = std::max(springCompliance, 0.0);
+    }
+    ImGui::Text("Springs: %zu in %zu colors", springs.size(), springs.getColorCount());
+    int constraintIterations = static_cast<int>(springs.getIterations());
+    if (ImGui::InputInt("Constraint Iterations", &constraintIterations) && constraintIterations > 0)
+        springs.setIterations(static_cast<size_t>(constraintIterations));
 
     // Change coefficient of friction
     ImGui::InputDouble("Friction Coefficient", &(physics->frictionCoef), 0.1, 10.0, "%.2f");
 
     // Change gravity
-    ImGui::InputDouble("Gravity X", &(physics->gravity.at(0)), 0.1, 1.0, "%.2f");
-    ImGui::InputDouble("Gravity Y", &(physics->gravity.at(1)), 0.1, 1.0, "%.2f");
+    ImGui::InputDouble("Gravity X", &physics->gravity.x, 0.1, 1.0, "%.2f");
+    ImGui::InputDouble("Gravity Y", &physics->gravity.y, 0.1, 1.0, "%.2f");
 
     // Change elasticity
     ImGui::InputDouble("Elasticity", &(physics->e), 0.1, 1.0, "%.2f");
@@ -240,40 +554,36 @@ void Screen::renderUI() {
 }
 
 void Screen::purgeParticles(int targetNumParticles) {
-    selectedParticle = nullptr;
-    size_t i{};
-    while (numParticles > targetNumParticles) {
-        removeParticle(particles.begin() + i);
-        i++;
-    }
+    selectedParticle = {};
+    world.purgeParticles(static_cast<size_t>(std::max(targetNumParticles, 0)));
 }
 
 void Screen::render() {
+    ScopedTimer timer{profiler, profileSeries.render};
     ImGui::SFML::Update(*win, dT.restart());
     renderUI();
     win->clear({0xE4, 0xE4, 0xE4, 255});
     win->draw(border);
-    // for (const auto& part : particles) win->draw(part->draw());
-    for (const auto& part : particles) {
-        const auto& [position, radius, color] = part->draw();
-        particleCircle.setRadius(radius);
-        particleCircle.setPosition(position.at(0), position.at(1));
-        particleCircle.setFillColor(color);
-        particleCircle.setOutlineColor(sf::Color::Red);
-        particleCircle.setOutlineThickness(part->outlineThickness);
-        win->draw(particleCircle);
-    }
-    for (const auto& spring : springs) win->draw(spring->draw());
+    if (player)
+        renderer.render(*win, replayParticles, replaySprings, {});
+    else
+        renderer.render(*win, particles, springs, highlightedParticles(), timestep.alpha());
+    if (boxSelecting) {
+        const auto mPos = sf::Mouse::getPosition(*win);
+        selectionBox.setPosition(std::min(dragStart.x, mPos.x), std::min(dragStart.y, mPos.y));
+        selectionBox.setSize({static_cast<float>(std::abs(mPos.x - dragStart.x)),
+                              static_cast<float>(std::abs(mPos.y - dragStart.y))});
+        win->draw(selectionBox);
+    }
     ImGui::SFML::Render(*win);
     win->display();
 }
 
 void Screen::handleEvents() {
+    ScopedTimer timer{profiler, profileSeries.events};
     // TheInputHandler::Instance()->update();
     sf::Event e{};
-    const double minDt = 0.0;
-    const double maxDt = 1.0;
-    const double step = 0.02;
+    bool clicked{};
     while (win->pollEvent(e)) {
         ImGui::SFML::ProcessEvent(*win, e);
         if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Escape) quit();
@@ -283,34 +593,32 @@ void Screen::handleEvents() {
         else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::F11)
             toggleFullscreen();
         else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Space)
-            for (int i{}; i < 10; i++) addRandomParticle();
-        else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Period) {
-            physics->dt += step;
-            if (physics->dt > maxDt) {
-                physics->dt = maxDt;
-            }
-            // std::cout << std::format("dt: {}\n", dt);
-        } else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Comma) {
-            physics->dt -= step;
-            if (physics->dt < minDt) {
-                physics->dt = minDt;
-            }
-            // std::cout << std::format("dt: {}\n", dt);
-        }
+            spawn(SpawnPattern::SCATTER, {});
+        else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::B)
+            spawn(SpawnPattern::BURST, sf::Mouse::getPosition(*win));
+        else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Period)
+            timeScale = std::min(timeScale + TIME_SCALE_STEP, MAX_TIME_SCALE);
+        else if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::Comma)
+            timeScale = std::max(timeScale - TIME_SCALE_STEP, 0.0);
 
         if (e.type == sf::Event::MouseButtonPressed && e.mouseButton.button == sf::Mouse::Left) {
             mousePressed = true;
+            clicked = true;
+            dragStart = {e.mouseButton.x, e.mouseButton.y};
+            boxSelecting = !placeMode && !springMode && sf::Keyboard::isKeyPressed(sf::Keyboard::LShift);
         }
 
         if (e.type == sf::Event::MouseButtonReleased && e.mouseButton.button == sf::Mouse::Left) {
             mousePressed = false;
+            if (boxSelecting) selectRect(dragStart, {e.mouseButton.x, e.mouseButton.y});
+            boxSelecting = false;
         }
 
         if (e.type == sf::Event::KeyPressed && e.key.code == sf::Keyboard::S) {
-            if (firstSpringParticle != nullptr && secondSpringParticle != nullptr) {
-                springs.push_back(std::make_unique<Spring>(firstSpringParticle, secondSpringParticle));
-                firstSpringParticle = nullptr;
-                secondSpringParticle = nullptr;
+            if (particles.contains(firstSpringParticle) && particles.contains(secondSpringParticle)) {
+                addSpringBetweenParticles(firstSpringParticle, secondSpringParticle);
+                firstSpringParticle = {};
+                secondSpringParticle = {};
             }
         }
     }
@@ -318,33 +626,28 @@ void Screen::handleEvents() {
     if (ImGui::GetIO().WantCaptureMouse) {
         // ImGui is capturing mouse input, so skip additional processing
         mousePressed = false;
+        boxSelecting = false;
         return;
     }
 
-    if (!placeMode && !springMode && mousePressed) {
-        selectParticle(selectedParticle);
+    if (!placeMode && !springMode && mousePressed && !boxSelecting) {
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+            selectCircle(sf::Mouse::getPosition(*win));
+        else
+            selectParticle(selectedParticle);
     }
 
-    if (!placeMode && springMode && mousePressed) {
-        if (firstSpringParticle && secondSpringParticle) return;
-
-        if (!firstSpringParticle) {
-            selectParticle(firstSpringParticle, [](PartPtr& particle) {});
-        }
-
-        if (firstSpringParticle != nullptr && secondSpringParticle == nullptr) {
-            selectParticle(secondSpringParticle, [this](PartPtr& particle) {
-                if (firstSpringParticle != nullptr) {
-                    // firstSpringParticle->gCircle().setOutlineThickness(0);  // Reset outline thickness
-                    firstSpringParticle->outlineThickness = 5;
-                }
-                if (particle != nullptr) {
-                    // particle->gCircle().setOutlineThickness(0);  // Reset outline thickness
-                    particle->outlineThickness = 0;
-                }
-                particle = nullptr;
-                firstSpringParticle = nullptr;
+    // One endpoint per click, holding the button down would pick the same particle for both
+    if (!placeMode && springMode && clicked && (firstSpringParticle.isNull() || secondSpringParticle.isNull())) {
+        if (firstSpringParticle.isNull()) {
+            selectParticle(firstSpringParticle, [](ParticleHandle&) {});
+        } else {
+            ParticleHandle picked{};
+            selectParticle(picked, [this](ParticleHandle& particle) {
+                particle = {};
+                firstSpringParticle = {};
             });
+            if (picked != firstSpringParticle) secondSpringParticle = picked;
         }
     }
 
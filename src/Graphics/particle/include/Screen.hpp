@@ -3,51 +3,50 @@
 #include <imgui-SFML.h>
 
 #include <SFML/Graphics.hpp>
+#include <array>
 #include <cmath>
 #include <functional>
 #include <iostream>
 #include <mlinalg/MLinalg.hpp>
-#include <random>
 
+#include "DistanceConstraints.hpp"
+#include "FixedTimestep.hpp"
 #include "InputHandler.hpp"
-#include "Particle.hpp"
+#include "ParticleSystem.hpp"
+#include "ParticleRenderer.hpp"
 #include "Physics.hpp"
+#include "Profiler.hpp"
+#include "Recording.hpp"
 #include "SFML_utils.hpp"
-#include "Spring.hpp"
+#include "Spawner.hpp"
+#include "World.hpp"
 #include "imgui.h"
 
 using std::cout;
 using namespace SDL_Utils;
 using namespace SFML_utils;
+using namespace mlinalg;
 
-using ParticleGroups = std::vector<std::vector<PartPtr>>;
-using Callback = std::function<void(PartPtr&)>;
+using Callback = std::function<void(ParticleHandle&)>;
 
 class Screen {
    public:
-    bool init(const std::string& title, Vector2<int> dim, bool fullscreen, double dt = 1, uint framerate = 60);
+    bool init(const std::string& title, Vector2<int> dim, bool fullscreen, int substeps = 1, uint framerate = 60);
     void update();
     void render();
     void handleEvents();
     static void cleanupImGui();
     void clean();
     void quit();
-    void addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass, sf::Color color);
-    void removeParticle(const PartPtr& particle);
-
-    template <typename Itr>
-    void removeParticle(Itr itr) {
-        particles.erase(itr);
-        numParticles--;
-    }
-
-    void addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass);
-    void addSpringBetweenParticles(const PartPtr& p1, const PartPtr& p2);
+    ParticleHandle addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass, sf::Color color);
+    ParticleHandle addParticle(const Vector2<double>& pos, const Vector2<double>& vel, int mass);
+    void removeParticle(ParticleHandle particle);
+    void addSpringBetweenParticles(ParticleHandle p1, ParticleHandle p2);
     static std::unique_ptr<Screen> instance;
     static std::unique_ptr<Screen>& Instance();
     [[nodiscard]] bool isRunning() const { return running; }
     [[nodiscard]] const RenderWindowPtr& getWindow() const { return win; }
-    [[nodiscard]] size_t getNumParticles() const { return numParticles; }
+    [[nodiscard]] size_t getNumParticles() const { return particles.size(); }
     sf::Time getElapsed() { return elapsed; }
     void restartClock() { elapsed = clock.restart(); }
 
@@ -63,6 +62,11 @@ class Screen {
     void destroy();
     void toggleFullscreen();
     void renderUI();
+    void configureTimestep();
+    void renderRecordingUI();
+    void renderProfilerUI();
+    void renderSpawnerUI();
+    void renderBroadPhaseUI();
 
     // Class members
     sf::Clock clock;
@@ -74,30 +78,111 @@ class Screen {
     bool running{};
     sf::RectangleShape border;
 
-    // Physics
-    PhysicsType physics{new SimplePhysics(0.0, particles, dim)};
+    // Profiling, one sample per frame for every series
+    struct ProfileSeries {
+        explicit ProfileSeries(Profiler& profiler) {
+            frame = profiler.series("Frame");
+            events = profiler.series("Events");
+            integrate = profiler.series("Integrate");
+            for (size_t method{}; method < COLLISION_METHOD_COUNT; method++) {
+                broadPhase[method] = profiler.series(
+                    std::format("Broad-phase: {}", parseCollisionMethods(static_cast<CollisionDetection>(method))));
+            }
+            narrowPhase = profiler.series("Narrow-phase");
+            constraints = profiler.series("Constraints");
+            sleep = profiler.series("Sleep");
+            cull = profiler.series("Cull");
+            render = profiler.series("Render");
+        }
+
+        size_t frame;
+        size_t events;
+        size_t integrate;
+        std::array<size_t, COLLISION_METHOD_COUNT> broadPhase;
+        size_t narrowPhase;
+        size_t constraints;
+        size_t sleep;
+        size_t cull;
+        size_t render;
+    };
+    Profiler profiler;
+    ProfileSeries profileSeries{profiler};
+    std::vector<float> profileHistory;
+    // Broad-phase switches of the selector already written to the log
+    void logBroadPhaseDecisions();
+    size_t loggedDecisions{};
+
+    // Simulation
+    static constexpr size_t MAX_CATCH_UP_FRAMES{2};  // Steps past this many frames' worth are dropped
+    static constexpr double MAX_TIME_SCALE{4};
+    static constexpr double TIME_SCALE_STEP{0.1};
+    World world;
+    ParticleSystem& particles{world.particles};
+    DistanceConstraints& springs{world.springs};
+    PhysicsType& physics{world.physics};
+    FixedTimestep timestep{1.0 / 60, MAX_CATCH_UP_FRAMES};
+    uint framerate{60};
+    int substeps{1};
+    double timeScale{1};  // Simulated seconds per real second
+    double simTime{};
+
+    // Recording and replay, a replay takes over the window from the simulation until it is closed
+    void startRecording();
+    void stopRecording();
+    void openReplay();
+    void updateReplay();
+    void showReplayFrame(size_t frame);
+    std::unique_ptr<Recorder> recorder;
+    std::unique_ptr<Player> player;
+    ParticleSystem replayParticles;
+    DistanceConstraints replaySprings;  // Springs are not recorded
+    char recordingPath[256]{"capture.prec"};
+    double recordingQuantum{};  // 0 records exactly
+    double replayTime{};        // Simulated seconds since the first frame
+    double replaySpeed{1};
+    bool replayPaused{};
+    std::string recordingStatus;
+
+    // Spawning, Space scatters spawnCount particles over the border and B bursts them from the mouse
+    enum class SpawnPattern { SCATTER = 0, BURST, LATTICE };
+    void spawn(SpawnPattern pattern, sf::Vector2i at);
+    Spawner spawner;
+    SpawnAttributes spawnAttributes;
+    StreamEmitter emitter;
+    bool streaming{};
+    int spawnPattern{};
+    int spawnCount{10};
+    float burstRadius{50};
+    int latticeColumns{100};
+    int latticeRows{100};
+    float latticeSpacing{8};
 
     // Particle methods
-    void addRandomParticle();
     void purgeParticles(int targetNumParticles);
-    void cullOutOfBoundsParticles();
     void selectParticle(
-        PartPtr& selection, const Callback& endCallback = [](PartPtr& particle) {
-            if (particle != nullptr) particle->outlineThickness = 0;
-            particle = nullptr;
-        });
-
-    // Particle members
-    std::vector<PartPtr> particles;
-    std::vector<SpringPtr> springs;
-    size_t numParticles{};
-
-    sf::CircleShape particleCircle;
-
-    PartPtr selectedParticle{nullptr};
-
-    PartPtr firstSpringParticle{nullptr};
-    PartPtr secondSpringParticle{nullptr};
+        ParticleHandle& selection, const Callback& endCallback = [](ParticleHandle& particle) { particle = {}; });
+    // Indices of the selected particles, drawn with an outline
+    const std::vector<size_t>& highlightedParticles();
+    // Multi-select, box and brush selections add to the current one
+    void addToSelection(const std::vector<size_t>& indices);
+    void selectRect(sf::Vector2i from, sf::Vector2i to);
+    void selectCircle(sf::Vector2i center);
+
+    ParticleRenderer renderer;
+    std::vector<size_t> highlighted;
+
+    ParticleHandle selectedParticle{};
+    std::vector<ParticleHandle> selectedParticles;  // Sorted by id
+    std::vector<size_t> queryResult;
+    sf::Vector2i dragStart;
+    bool boxSelecting{};
+    float brushRadius{30};
+    sf::RectangleShape selectionBox;
+
+    ParticleHandle firstSpringParticle{};
+    ParticleHandle secondSpringParticle{};
+    double springRestLength{5};
+    double springCompliance{DistanceConstraints::DEFAULT_COMPLIANCE};
 
     sf::Clock dT;  // Clock for measuring time step
     bool mousePressed{false};
@@ -113,7 +198,6 @@ class Screen {
     float borderYMin;
     float borderXMax;
     float borderYMax;
-    bool cull{};
     int borderThickness{10};
     bool borderMatchDimens{true};
     bool precisionPlacement{};
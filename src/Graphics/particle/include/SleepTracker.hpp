@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "DistanceConstraints.hpp"
+#include "ParticleSystem.hpp"
+#include "UniformGrid.hpp"
+#include "aliases.hpp"
+
+struct SleepSettings {
+    bool enabled{false};
+    double restSpeed{2};      // Speed a resting particle stays under, on top of what one step of gravity adds to it
+    uint16_t restFrames{30};  // Steps a particle and its neighbours rest before it sleeps
+};
+
+// Sleeping of resting particles
+// Every particle counts the steps in a row it has been slower than the rest speed and goes to sleep once it and every
+// particle touching it or sharing a spring with it have rested long enough, so a particle still moving keeps its
+// neighbours awake. Sleep is decided around each particle rather than for whole islands at once because particle
+// contacts are elastic, a settled pile always keeps a few particles bouncing somewhere and would never sleep as a
+// whole.
+//
+// Sleeping particles that touch or share a spring form an island and wake together, found by a flood fill over a
+// grid of the particles. That happens when the step gives one of them more speed than a resting particle has, from a
+// hit or a spring, and whenever the owner queues one.
+class SleepTracker {
+   public:
+    static constexpr Real CONTACT_SLACK{1};  // Gap up to which two particles count as touching
+
+    // Wakes the sleeping particles the step pushed harder than a resting particle moves and counts resting steps,
+    // every few calls it also puts the particles settled along with their neighbours to sleep. Called once the step
+    // has moved every particle, returns whether particles were queued to wake.
+    bool update(ParticleSystem& particles, const PairList& pairs, const DistanceConstraints& springs,
+                const SleepSettings& settings, double gravityStep) {
+        const auto n = particles.size();
+
+        size_t rested{};
+        for (size_t i{}; i < n; i++) {
+            const auto limit = restLimit(particles, i, settings, gravityStep);
+            const auto speedSq = particles.vx[i] * particles.vx[i] + particles.vy[i] * particles.vy[i];
+            if (particles.isAsleep(i)) {
+                // Sleeping particles still take part in contacts and springs, what they are given is either a hit
+                // that wakes them with their island or a nudge they stay put through
+                if (speedSq > limit * limit)
+                    pending.push_back(static_cast<uint32_t>(i));
+                else
+                    particles.sleep(i);
+                continue;
+            }
+            auto& frames = particles.restFrames[i];
+            frames = speedSq <= limit * limit ? static_cast<uint16_t>(std::min<int>(frames + 1, MAX_FRAMES)) : 0;
+            if (frames >= settings.restFrames) rested++;
+        }
+        if (rested == 0 || ++sinceCheck < CHECK_INTERVAL) return !pending.empty();
+        sinceCheck = 0;
+
+        // A particle that has not rested long enough keeps everything touching it or tied to it awake, only pairs of
+        // one settled particle and one that is not need the distance
+        settled.resize(n);
+        for (size_t i{}; i < n; i++)
+            settled[i] = particles.isAsleep(i) || particles.restFrames[i] >= settings.restFrames;
+        held.assign(n, 0);
+        for (const auto [a, b] : pairs) {
+            if (settled[a] != settled[b] && touching(particles, a, b)) held[settled[a] ? a : b] = 1;
+        }
+        for (size_t k{}; k < springs.size(); k++) {
+            const auto a = particles.indexOf(springs.getFirst(k));
+            const auto b = particles.indexOf(springs.getSecond(k));
+            if (a == ParticleSystem::NPOS || b == ParticleSystem::NPOS || settled[a] == settled[b]) continue;
+            held[settled[a] ? a : b] = 1;
+        }
+        for (size_t i{}; i < n; i++) {
+            if (!particles.isAsleep(i) && settled[i] && !held[i]) particles.sleep(i);
+        }
+        return !pending.empty();
+    }
+
+    // Particle i and everything connected to it wakes on the next wakePending
+    void queueWake(size_t i) { pending.push_back(static_cast<uint32_t>(i)); }
+    [[nodiscard]] bool hasPending() const { return !pending.empty(); }
+
+    // Wakes the queued particles and every sleeping particle connected to them, no particle may have moved further
+    // than drift from where index binned it
+    void wakePending(ParticleSystem& particles, const DistanceConstraints& springs, const UniformGrid& index,
+                     double drift = 0) {
+        buildSpringAdjacency(particles, springs);
+        auto& stack = pending;
+        const auto visit = [&](size_t j) {
+            if (!particles.isAsleep(j)) return;
+            particles.wake(j);
+            stack.push_back(static_cast<uint32_t>(j));
+        };
+
+        // Seeds may be awake, they still wake what they touch
+        for (const auto i : stack) particles.wake(i);
+        while (!stack.empty()) {
+            const auto i = stack.back();
+            stack.pop_back();
+            const auto reach = static_cast<double>(particles.radius[i] + CONTACT_SLACK) + drift;
+            const auto x = static_cast<double>(particles.x[i]);
+            const auto y = static_cast<double>(particles.y[i]);
+            index.queryBox(x - reach, y - reach, x + reach, y + reach, [&](size_t j) {
+                if (j != i && touching(particles, i, j)) visit(j);
+            });
+            if (!springStart.empty()) {
+                for (auto k = springStart[i]; k < springStart[i + 1]; k++) visit(springNeighbours[k]);
+            }
+        }
+    }
+
+    void wakeAll(ParticleSystem& particles) {
+        for (size_t i{}; i < particles.size(); i++) particles.wake(i);
+        pending.clear();
+    }
+
+   private:
+    static constexpr int MAX_FRAMES{std::numeric_limits<uint16_t>::max()};
+    // Steps between looks at the neighbours of rested particles, a pass over every candidate pair
+    static constexpr size_t CHECK_INTERVAL{8};
+
+    // A particle resting on something under gravity still picks up one step of it every step before the contact
+    // takes it away again
+    static Real restLimit(const ParticleSystem& particles, size_t i, const SleepSettings& settings,
+                          double gravityStep) {
+        return static_cast<Real>(settings.restSpeed + gravityStep * particles.mass[i]);
+    }
+
+    static bool touching(const ParticleSystem& particles, size_t a, size_t b) {
+        const auto dx = particles.x[a] - particles.x[b];
+        const auto dy = particles.y[a] - particles.y[b];
+        const auto reach = particles.radius[a] + particles.radius[b] + CONTACT_SLACK;
+        return dx * dx + dy * dy <= reach * reach;
+    }
+
+    // Spring partners of every slot laid out back to back, empty without springs
+    void buildSpringAdjacency(const ParticleSystem& particles, const DistanceConstraints& springs) {
+        springStart.clear();
+        springNeighbours.clear();
+        if (springs.empty()) return;
+
+        const auto n = particles.size();
+        springStart.assign(n + 1, 0);
+        springSlots.clear();
+        for (size_t k{}; k < springs.size(); k++) {
+            const auto a = particles.indexOf(springs.getFirst(k));
+            const auto b = particles.indexOf(springs.getSecond(k));
+            if (a == ParticleSystem::NPOS || b == ParticleSystem::NPOS) continue;
+            springSlots.push_back({static_cast<uint32_t>(a), static_cast<uint32_t>(b)});
+            springStart[a + 1]++;
+            springStart[b + 1]++;
+        }
+        std::partial_sum(springStart.begin(), springStart.end(), springStart.begin());
+
+        springNeighbours.resize(springStart[n]);
+        std::vector<uint32_t> fill{springStart.begin(), springStart.end() - 1};
+        for (const auto [a, b] : springSlots) {
+            springNeighbours[fill[a]++] = b;
+            springNeighbours[fill[b]++] = a;
+        }
+    }
+
+    std::vector<uint32_t> pending;  // Particles to wake, then the flood fill stack
+    std::vector<uint8_t> settled;   // Per slot, asleep or rested for long enough
+    std::vector<uint8_t> held;      // Per slot, whether a neighbour that is still moving keeps it awake
+    PairList springSlots;           // Slots of the springs whose particles both exist, scratch for the adjacency
+    std::vector<uint32_t> springStart;
+    std::vector<uint32_t> springNeighbours;
+    size_t sinceCheck{};
+};
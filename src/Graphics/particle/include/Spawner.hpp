@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <random>
+
+#include "ParticleSystem.hpp"
+#include "Vec2.hpp"
+
+// xoshiro256++ pseudo random generator
+// Four words of state and a few shifts, rotations and additions per number, cheap to keep around and to step
+// compared to the standard engines. Seeded through splitmix64 so any seed, 0 included, gives a well mixed state. It
+// meets UniformRandomBitGenerator so it also drives the standard distributions.
+class Xoshiro256 {
+   public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t value = 0) { seed(value); }
+
+    void seed(uint64_t value) {
+        for (auto& word : state) {
+            value += 0x9E3779B97F4A7C15;
+            auto z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const auto result = std::rotl(state[0] + state[3], 23) + state[0];
+        const auto shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = std::rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, 1) from the top 53 bits
+    double uniform() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+
+    // Uniform in [lo, hi] by scaling a 64 bit number into the range, the bias is below 2^-32 for any range used here
+    int64_t uniformInt(int64_t lo, int64_t hi) {
+        const auto range = static_cast<uint64_t>(hi - lo) + 1;
+        return lo + static_cast<int64_t>((static_cast<unsigned __int128>((*this)()) * range) >> 64);
+    }
+
+   private:
+    std::array<uint64_t, 4> state{};
+};
+
+// What spawned particles look like, every value drawn uniformly from its range
+struct SpawnAttributes {
+    int minMass{2};
+    int maxMass{10};
+    double minSpeed{0};
+    double maxSpeed{100};
+    bool randomColor{true};
+    Color color{0, 0, 0, 255};  // When randomColor is off
+};
+
+// Continuous source of particles, emitting rate particles per simulated second
+struct StreamEmitter {
+    Vec2d position;
+    Vec2d direction{1, 0};  // Unit vector
+    double rate{200};
+    double spread{0.2};  // Radians either side of direction
+    double pending{};    // Fraction of a particle carried over to the next step
+};
+
+// Bulk particle creation from one persistent generator
+// Every pattern makes room for all its particles up front and appends them in one pass, so spawning a million
+// particles is a single growth of the particle arrays and no allocation per particle. The new particles take the last
+// slots, each call returns how many it added.
+class Spawner {
+   public:
+    explicit Spawner(uint64_t seed = std::random_device{}()) : rng{seed} {}
+
+    // Uniformly over the box, flying in random directions
+    size_t scatter(ParticleSystem& particles, size_t count, Vec2d min, Vec2d max, const SpawnAttributes& attributes) {
+        prepare(particles, count);
+        for (size_t i{}; i < count; i++) {
+            const Vec2d position{rng.uniform(min.x, max.x), rng.uniform(min.y, max.y)};
+            add(particles, position, randomDirection() * speed(attributes), attributes);
+        }
+        return count;
+    }
+
+    // Uniformly over a disc, flying straight out from its center
+    size_t burst(ParticleSystem& particles, size_t count, Vec2d center, double radius,
+                 const SpawnAttributes& attributes) {
+        prepare(particles, count);
+        for (size_t i{}; i < count; i++) {
+            const auto direction = randomDirection();
+            // The root keeps the density even, more particles fall at large radii where there is more room
+            const auto distance = radius * std::sqrt(rng.uniform());
+            add(particles, center + direction * distance, direction * speed(attributes), attributes);
+        }
+        return count;
+    }
+
+    // Columns by rows grid with its first particle at origin, every particle at the same velocity
+    size_t lattice(ParticleSystem& particles, size_t columns, size_t rows, Vec2d origin, double spacing,
+                   Vec2d velocity, const SpawnAttributes& attributes) {
+        const auto count = columns * rows;
+        prepare(particles, count);
+        for (size_t row{}; row < rows; row++) {
+            for (size_t column{}; column < columns; column++) {
+                const Vec2d offset{static_cast<double>(column) * spacing, static_cast<double>(row) * spacing};
+                add(particles, origin + offset, velocity, attributes);
+            }
+        }
+        return count;
+    }
+
+    // Emits the particles due over dt seconds of simulated time
+    size_t stream(ParticleSystem& particles, StreamEmitter& emitter, double dt, const SpawnAttributes& attributes) {
+        emitter.pending += std::max(emitter.rate, 0.0) * dt;
+        const auto count = static_cast<size_t>(emitter.pending);
+        emitter.pending -= static_cast<double>(count);
+        prepare(particles, count);
+
+        const auto heading = std::atan2(emitter.direction.y, emitter.direction.x);
+        for (size_t i{}; i < count; i++) {
+            const auto angle = heading + rng.uniform(-emitter.spread, emitter.spread);
+            const Vec2d direction{std::cos(angle), std::sin(angle)};
+            add(particles, emitter.position, direction * speed(attributes), attributes);
+        }
+        return count;
+    }
+
+    Xoshiro256& generator() { return rng; }
+
+   private:
+    // Grows the arrays at least geometrically, reserving exactly what each small call needs would reallocate on
+    // every call
+    static void prepare(ParticleSystem& particles, size_t count) {
+        const auto needed = particles.size() + count;
+        if (needed > particles.capacity()) particles.reserve(std::max(needed, 2 * particles.capacity()));
+    }
+
+    Vec2d randomDirection() {
+        const auto angle = rng.uniform(0, 2 * std::numbers::pi);
+        return {std::cos(angle), std::sin(angle)};
+    }
+
+    double speed(const SpawnAttributes& attributes) { return rng.uniform(attributes.minSpeed, attributes.maxSpeed); }
+
+    void add(ParticleSystem& particles, Vec2d position, Vec2d velocity, const SpawnAttributes& attributes) {
+        const auto mass = rng.uniformInt(attributes.minMass, std::max(attributes.minMass, attributes.maxMass));
+        auto color = attributes.color;
+        if (attributes.randomColor) {
+            // One number holds all three channels
+            const auto bits = rng();
+            color = {static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8), static_cast<uint8_t>(bits >> 16),
+                     255};
+        }
+        particles.add(static_cast<Real>(position.x), static_cast<Real>(position.y), static_cast<Real>(velocity.x),
+                      static_cast<Real>(velocity.y), static_cast<Real>(mass), color);
+    }
+
+    Xoshiro256 rng;
+};
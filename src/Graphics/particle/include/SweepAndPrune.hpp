@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "aliases.hpp"
+
+// Incremental sort and sweep broad-phase
+// Every axis keeps its intervals sorted by their lower end between frames. Particles barely move from one frame to
+// the next so the order is nearly right already and an insertion sort puts it back in close to linear time. The
+// sweep then walks forward from each interval until the lower ends pass its upper end, every interval it meets
+// overlaps it on that axis.
+class SweepAndPrune {
+   public:
+    enum class Mode { SINGLE_AXIS, DUAL_AXIS };
+
+    // Single axis sweeps along x only. Dual axis keeps both axes sorted, sweeps along the one the particles are
+    // more spread out on and drops pairs that do not also overlap on the other.
+    void findPairs(const ParticleSystem& particles, PairList& pairs, Mode mode = Mode::SINGLE_AXIS) {
+        pairs.clear();
+        const auto n = particles.size();
+
+        update(xAxis, particles.x, particles);
+        if (mode == Mode::SINGLE_AXIS) {
+            sweep(xAxis, pairs);
+            return;
+        }
+
+        update(yAxis, particles.y, particles);
+        const auto spreadX = n > 0 ? xAxis.back().min - xAxis.front().min : 0;
+        const auto spreadY = n > 0 ? yAxis.back().min - yAxis.front().min : 0;
+        if (spreadX >= spreadY)
+            sweep(xAxis, pairs, &particles.y, &particles);
+        else
+            sweep(yAxis, pairs, &particles.x, &particles);
+    }
+
+    // Insertion moves made by the last update, a measure of how far from sorted the previous order was
+    [[nodiscard]] size_t getLastMoves() const { return lastMoves; }
+
+   private:
+    struct Interval {
+        Real min;
+        Real max;
+        uint32_t id;
+    };
+    using Axis = std::vector<Interval>;
+
+    // Past this many moves per interval the scene changed too much for insertion sort to pay off
+    static constexpr size_t MAX_MOVES_PER_INTERVAL{8};
+
+    void update(Axis& axis, const std::vector<Real>& position, const ParticleSystem& particles) {
+        const auto n = particles.size();
+
+        // Slots are dense so the stored order stays a permutation of [0, n) while the count is unchanged, new
+        // particles are appended and removed slots past the end dropped
+        if (axis.size() > n)
+            std::erase_if(axis, [n](const Interval& interval) { return interval.id >= n; });
+        for (auto id = axis.size(); id < n; id++) axis.push_back({0, 0, static_cast<uint32_t>(id)});
+
+        for (auto& interval : axis) {
+            interval.min = position[interval.id] - particles.radius[interval.id];
+            interval.max = position[interval.id] + particles.radius[interval.id];
+        }
+
+        lastMoves = 0;
+        const auto budget = MAX_MOVES_PER_INTERVAL * n;
+        for (size_t i{1}; i < n; i++) {
+            const auto current = axis[i];
+            auto j = i;
+            while (j > 0 && axis[j - 1].min > current.min) {
+                axis[j] = axis[j - 1];
+                j--;
+            }
+            axis[j] = current;
+            lastMoves += i - j;
+
+            if (lastMoves > budget) {
+                std::sort(axis.begin(), axis.end(), [](const Interval& a, const Interval& b) { return a.min < b.min; });
+                return;
+            }
+        }
+    }
+
+    static void sweep(const Axis& axis, PairList& pairs, const std::vector<Real>* other = nullptr,
+                      const ParticleSystem* particles = nullptr) {
+        const auto n = axis.size();
+        for (size_t i{}; i < n; i++) {
+            const auto& current = axis[i];
+            for (auto j = i + 1; j < n && axis[j].min <= current.max; j++) {
+                const auto a = current.id;
+                const auto b = axis[j].id;
+                if (other) {
+                    const auto& pos = *other;
+                    const auto& radius = particles->radius;
+                    if (pos[a] + radius[a] < pos[b] - radius[b] || pos[b] + radius[b] < pos[a] - radius[a])
+                        continue;
+                }
+                pairs.push_back(a < b ? CandidatePair{a, b} : CandidatePair{b, a});
+            }
+        }
+    }
+
+    Axis xAxis;
+    Axis yAxis;
+    size_t lastMoves{};
+};
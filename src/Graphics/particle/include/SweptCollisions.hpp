@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "UniformGrid.hpp"
+#include "aliases.hpp"
+#include "kernels.hpp"
+
+// Continuous collision detection for particles that move further than their radius in one step
+// The discrete phases only see where a step leaves the particles, a fast particle can end a step past a wall or on the
+// far side of another particle without ever overlapping it. Run after the step has moved the particles, this sweeps
+// every fast particle along its straight path through the step and finds the fraction of the step at which it first
+// touches a wall or another particle, both particles moving. Contacts are resolved earliest first: the particles are
+// put where they touch, bounce and cover the rest of the step along their new velocities. That path is swept again
+// for the next contact, up to MAX_CONTACTS per particle per step, the last of which halts the particle where it
+// touches.
+//
+// Every pair that comes into touch during the step is resolved here, overlapping at the end of it or not, the narrow
+// phase would push a particle that ends the step past another's center out the far side. Pairs that already overlap
+// where their paths start are left to the narrow phase. A scene with nothing fast costs a pass over the velocities.
+//
+// Paths are swept pass by pass, a path that starts after a contact only meets other particles from their own last
+// contacts on. In a crowd and at steps many radii long, a particle now and then slips past one that was hit later in
+// the step than it would have reached it.
+class SweptCollisions {
+   public:
+    static constexpr uint8_t MAX_CONTACTS{4};
+
+    // Resolves the contacts along the paths of the fast particles, the positions and velocities are the ones the
+    // step ended with. bounce(i, j) sets the velocities of two particles that just touch. Returns the contacts
+    // resolved.
+    template <typename Bounce>
+    size_t resolve(ParticleSystem& particles, const kernels::StepParams& params, Bounce&& bounce) {
+        hits = 0;
+        findFast(particles, params);
+        swept = moving.size();
+        if (moving.empty()) return 0;
+
+        // Particles CCD never moves stay where the grid has them, the moving ones are swept against each other
+        index.build(particles);
+        const auto n = particles.size();
+        start.assign(n, 0);
+        contacts.assign(n, 0);
+        halted.assign(n, 0);
+        isActive.assign(n, 0);
+        hitThisPass.assign(n, 0);
+        active = moving;
+
+        for (size_t pass{}; pass < MAX_PASSES && !active.empty(); pass++) {
+            findEvents(particles, params);
+            std::ranges::sort(events, {}, &Event::time);
+
+            bounced.clear();
+            for (auto event : events) {
+                // An earlier contact this pass changed the path, the contact has to still happen on the new one
+                if (hitThisPass[event.a] || (!event.isWall() && hitThisPass[event.b])) {
+                    event.time = event.isWall() ? wallContact(particles, params, event.a)
+                                                : pairContact(particles, params, event.a, event.b);
+                    if (event.time == NONE) continue;
+                }
+                if (event.isWall())
+                    hitWall(particles, params, event.a, event.time);
+                else
+                    hitParticle(particles, params, event.a, event.b, event.time, bounce);
+                hits++;
+            }
+
+            for (const auto i : active) isActive[i] = 0;
+            active.clear();
+            for (const auto i : bounced) {
+                hitThisPass[i] = 0;
+                if (!halted[i]) active.push_back(i);
+            }
+        }
+
+        // Paths still left after the last pass went unchecked, those particles at least stay in the box
+        for (const auto i : active) bounceOffWalls(particles, params, i);
+        return hits;
+    }
+
+    // Particles swept and contacts resolved in the last step
+    [[nodiscard]] size_t getSwept() const { return swept; }
+    [[nodiscard]] size_t getHits() const { return hits; }
+
+   private:
+    static constexpr size_t MAX_PASSES{4 * MAX_CONTACTS};
+    static constexpr Real NONE{std::numeric_limits<Real>::max()};
+    static constexpr uint32_t WALL{std::numeric_limits<uint32_t>::max()};
+
+    // Contact of a with b, or of a with whichever wall it reaches first
+    struct Event {
+        Real time;  // Fraction of the step
+        uint32_t a;
+        uint32_t b;
+
+        [[nodiscard]] bool isWall() const { return b == WALL; }
+    };
+
+    // Velocity along the particle's current path, a halted particle stays where it is for the rest of the step
+    [[nodiscard]] Real pathVx(const ParticleSystem& particles, size_t i) const {
+        return halted[i] ? 0 : particles.vx[i];
+    }
+
+    [[nodiscard]] Real pathVy(const ParticleSystem& particles, size_t i) const {
+        return halted[i] ? 0 : particles.vy[i];
+    }
+
+    // Where particle i was at time t along its current path
+    Real xAt(const ParticleSystem& particles, const kernels::StepParams& params, size_t i, Real t) const {
+        return particles.x[i] - (1 - t) * pathVx(particles, i) * params.dt;
+    }
+
+    Real yAt(const ParticleSystem& particles, const kernels::StepParams& params, size_t i, Real t) const {
+        return particles.y[i] - (1 - t) * pathVy(particles, i) * params.dt;
+    }
+
+    void findFast(const ParticleSystem& particles, const kernels::StepParams& params) {
+        moving.clear();
+        isMoving.assign(particles.size(), 0);
+        Real slowStepSq{};
+        const auto dtSq = params.dt * params.dt;
+        for (size_t i{}; i < particles.size(); i++) {
+            const auto r = particles.radius[i];
+            const auto stepSq = (particles.vx[i] * particles.vx[i] + particles.vy[i] * particles.vy[i]) * dtSq;
+            if (stepSq > r * r) {
+                moving.push_back(static_cast<uint32_t>(i));
+                isMoving[i] = 1;
+            } else {
+                slowStepSq = std::max(slowStepSq, stepSq);
+            }
+        }
+        slowStep = std::sqrt(slowStepSq);
+    }
+
+    // Contacts along the remaining paths of the active particles with the walls, the particles CCD has not moved and
+    // the moving particles
+    void findEvents(const ParticleSystem& particles, const kernels::StepParams& params) {
+        events.clear();
+        for (const auto i : active) {
+            isActive[i] = 1;
+            if (const auto t = wallContact(particles, params, i); t != NONE) events.push_back({t, i, WALL});
+
+            // The grid has the particles CCD has not moved where they end the step, no further than slowStep from
+            // anywhere along their paths, and grows the box by their radius itself
+            const auto reach = particles.radius[i] + slowStep;
+            const auto x0 = xAt(particles, params, i, start[i]);
+            const auto y0 = yAt(particles, params, i, start[i]);
+            const auto x1 = particles.x[i];
+            const auto y1 = particles.y[i];
+            index.queryBox(std::min(x0, x1) - reach, std::min(y0, y1) - reach, std::max(x0, x1) + reach,
+                           std::max(y0, y1) + reach, [&](size_t j) {
+                if (isMoving[j]) return;
+                if (const auto t = pairContact(particles, params, i, j); t != NONE)
+                    events.push_back({t, i, static_cast<uint32_t>(j)});
+            });
+        }
+
+        // Sweep and prune over the boxes of the moving particles' paths, pairs with an active particle in them. Paths
+        // tend to run one way, a fast stream would overlap nearly everything along its direction, so the sweep runs
+        // along the axis the boxes are shorter on compared to how far they spread.
+        boxes.clear();
+        Real lengthX{}, lengthY{}, longestX{}, longestY{};
+        Real lowX{NONE}, lowY{NONE}, highX{-NONE}, highY{-NONE};
+        for (const auto i : moving) {
+            const auto r = particles.radius[i];
+            const auto x0 = xAt(particles, params, i, start[i]);
+            const auto y0 = yAt(particles, params, i, start[i]);
+            const auto x1 = particles.x[i];
+            const auto y1 = particles.y[i];
+            PathBox box{{std::min(x0, x1) - r, std::min(y0, y1) - r}, {std::max(x0, x1) + r, std::max(y0, y1) + r}, i};
+            lengthX += box.max[0] - box.min[0];
+            lengthY += box.max[1] - box.min[1];
+            longestX = std::max(longestX, box.max[0] - box.min[0]);
+            longestY = std::max(longestY, box.max[1] - box.min[1]);
+            lowX = std::min(lowX, box.min[0]);
+            lowY = std::min(lowY, box.min[1]);
+            highX = std::max(highX, box.max[0]);
+            highY = std::max(highY, box.max[1]);
+            boxes.push_back(box);
+        }
+        const size_t axis = lengthX * (highY - lowY) <= lengthY * (highX - lowX) ? 0 : 1;
+        const auto other = 1 - axis;
+        const auto longest = axis == 0 ? longestX : longestY;
+        std::ranges::sort(boxes, {}, [axis](const PathBox& box) { return box.min[axis]; });
+
+        const auto pair = [&](const PathBox& first, const PathBox& second) {
+            if (second.min[other] > first.max[other] || second.max[other] < first.min[other]) return;
+            if (const auto t = pairContact(particles, params, first.particle, second.particle); t != NONE)
+                events.push_back({t, first.particle, second.particle});
+        };
+        // Only the active boxes look for overlaps, after the first pass they are the few that made contact. Each
+        // looks ahead in the order like a plain sweep and back for the inactive boxes before it, which no sweep
+        // from them would find.
+        for (size_t k{}; k < boxes.size(); k++) {
+            const auto& first = boxes[k];
+            if (!isActive[first.particle]) continue;
+            for (auto l = k + 1; l < boxes.size() && boxes[l].min[axis] <= first.max[axis]; l++) pair(first, boxes[l]);
+            for (auto l = k; l-- > 0 && boxes[l].min[axis] >= first.min[axis] - longest;) {
+                if (!isActive[boxes[l].particle] && boxes[l].max[axis] >= first.min[axis]) pair(boxes[l], first);
+            }
+        }
+    }
+
+    // First time from the particle's last contact on at which it reaches a wall it ends the step past, or NONE
+    Real wallContact(const ParticleSystem& particles, const kernels::StepParams& params, size_t i) const {
+        const auto from = start[i];
+        const auto x = particles.x[i];
+        const auto y = particles.y[i];
+        const auto r = particles.radius[i];
+        const auto dx = pathVx(particles, i) * params.dt;
+        const auto dy = pathVy(particles, i) * params.dt;
+
+        auto earliest = NONE;
+        // Step fraction at which the particle is past the wall by the given depth, moving along d
+        const auto reach = [&](Real depth, Real d) {
+            if (depth <= 0) return;
+            earliest = std::min(earliest, std::max(from, 1 - depth / d));
+        };
+        if (dx < 0) reach(params.xMin - (x - r), -dx);
+        if (dx > 0) reach(x + r - params.xMax, dx);
+        if (dy > 0) reach(y + r - params.yMax, dy);
+        if (dy < 0) reach(params.yMin - (y - r), -dy);
+        return earliest;
+    }
+
+    // First time after both particles' last contacts at which they start to touch, or NONE when they do not or
+    // already overlap where their current paths start
+    Real pairContact(const ParticleSystem& particles, const kernels::StepParams& params, size_t a, size_t b) const {
+        // Relative position at the end of the step and relative motion over the step
+        const auto ex = particles.x[b] - particles.x[a];
+        const auto ey = particles.y[b] - particles.y[a];
+        const auto wx = (pathVx(particles, b) - pathVx(particles, a)) * params.dt;
+        const auto wy = (pathVy(particles, b) - pathVy(particles, a)) * params.dt;
+        const auto reach = particles.radius[a] + particles.radius[b];
+        const auto a2 = wx * wx + wy * wy;
+        if (a2 == 0) return NONE;
+
+        // Going back s of the step from its end the distance is |e - s w|, the roots are where it equals reach. The
+        // later of them in s is where the particles start to touch, whether or not they still overlap at the end. It
+        // lies before the paths start when they already overlapped there, those are the narrow phase's.
+        const auto c = ex * ex + ey * ey - reach * reach;
+        const auto b2 = ex * wx + ey * wy;
+        const auto discriminant = b2 * b2 - a2 * c;
+        if (discriminant <= 0) return NONE;
+
+        const auto time = 1 - (b2 + std::sqrt(discriminant)) / a2;
+        if (time < std::max(start[a], start[b]) || time >= 1) return NONE;
+        return time;
+    }
+
+    // Puts the particle where it touches the wall, bounces it the way the step does and lets it cover the rest of the
+    // step
+    void hitWall(ParticleSystem& particles, const kernels::StepParams& params, size_t i, Real time) {
+        particles.x[i] = xAt(particles, params, i, time);
+        particles.y[i] = yAt(particles, params, i, time);
+        bounceOffWalls(particles, params, i);
+        contacted(particles, params, i, time);
+    }
+
+    // Bounces a particle touching or past a wall and moving out off it the way the step does, and puts it inside
+    static void bounceOffWalls(ParticleSystem& particles, const kernels::StepParams& params, size_t i) {
+        auto x = particles.x[i];
+        auto y = particles.y[i];
+        auto vx = particles.vx[i];
+        auto vy = particles.vy[i];
+        const auto r = particles.radius[i];
+        const auto restitution = 1 + params.elasticity;
+        // Within a hair of the wall it touches
+        const auto slack = r * static_cast<Real>(1e-3);
+
+        if ((x - r <= params.xMin + slack && vx < 0) || (x + r >= params.xMax - slack && vx > 0)) {
+            vx = vx - restitution * vx;
+            vy = vy - params.friction * vy * params.dt;
+        }
+        if ((y + r >= params.yMax - slack && vy > 0) || (y - r <= params.yMin + slack && vy < 0)) {
+            vy = vy - restitution * vy;
+            vx = vx - params.friction * vx * params.dt;
+        }
+
+        particles.x[i] = std::clamp(x, params.xMin + r, params.xMax - r);
+        particles.y[i] = std::clamp(y, params.yMin + r, params.yMax - r);
+        particles.vx[i] = vx;
+        particles.vy[i] = vy;
+    }
+
+    template <typename Bounce>
+    void hitParticle(ParticleSystem& particles, const kernels::StepParams& params, size_t a, size_t b, Real time,
+                     Bounce& bounce) {
+        for (const auto i : {a, b}) {
+            particles.x[i] = xAt(particles, params, i, time);
+            particles.y[i] = yAt(particles, params, i, time);
+        }
+        bounce(a, b);
+        for (const auto i : {a, b}) contacted(particles, params, i, time);
+    }
+
+    // The particle has a new path from time on and covers the rest of the step along it, it is swept again on the next
+    // pass. Its last contact halts it where it touches instead, the rest of its path would go unchecked. A halted
+    // particle keeps its velocity for the next step and stays put for this one, other particles still bounce off it.
+    void contacted(ParticleSystem& particles, const kernels::StepParams& params, size_t i, Real time) {
+        if (!halted[i]) {
+            start[i] = time;
+            if (++contacts[i] >= MAX_CONTACTS) {
+                halted[i] = 1;
+            } else {
+                particles.x[i] += (1 - time) * particles.vx[i] * params.dt;
+                particles.y[i] += (1 - time) * particles.vy[i] * params.dt;
+            }
+        }
+        if (!isMoving[i]) {
+            isMoving[i] = 1;
+            moving.push_back(static_cast<uint32_t>(i));
+        }
+        if (!hitThisPass[i]) {
+            hitThisPass[i] = 1;
+            bounced.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Box around a moving particle's path, x then y
+    struct PathBox {
+        std::array<Real, 2> min;
+        std::array<Real, 2> max;
+        uint32_t particle;
+    };
+
+    UniformGrid index;
+    Real slowStep{};  // Longest step of a particle that is not fast
+    std::vector<uint32_t> moving;   // Fast particles and every particle a contact moved
+    std::vector<uint8_t> isMoving;  // Per slot
+    std::vector<uint32_t> active;   // Particles whose paths are swept this pass
+    std::vector<uint32_t> bounced;  // Particles that made contact this pass
+    std::vector<Real> start;        // Per slot, fraction of the step the particle's current path starts at
+    std::vector<uint8_t> contacts;  // Per slot, contacts resolved this step
+    std::vector<uint8_t> halted;    // Per slot, out of contacts and staying where the last one left it
+    std::vector<uint8_t> isActive;     // Per slot
+    std::vector<uint8_t> hitThisPass;  // Per slot
+    std::vector<Event> events;
+    std::vector<PathBox> boxes;
+    size_t swept{};
+    size_t hits{};
+};
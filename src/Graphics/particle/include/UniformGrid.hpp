@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "aliases.hpp"
+
+// Uniform grid broad-phase
+// Particles are binned by their center with a counting sort into one flat array, cellStart[c] is where cell c's
+// particles begin in it and cellCount[c] how many there are. Cells are at least as wide as the largest particle so
+// two touching particles are always in the same or neighbouring cells. Every buffer is kept between frames and only
+// grows, a steady scene rebuilds the grid without touching the heap. Pairs of two sleeping particles are never
+// emitted and two neighbouring cells holding only sleeping particles are not paired at all.
+class UniformGrid {
+   public:
+    void build(const ParticleSystem& particles) {
+        const auto n = particles.size();
+        binnedX.assign(particles.x.begin(), particles.x.end());
+        binnedY.assign(particles.y.begin(), particles.y.end());
+        if (n == 0) {
+            cols = rows = 0;
+            return;
+        }
+
+        Real minX{std::numeric_limits<Real>::max()};
+        Real minY{std::numeric_limits<Real>::max()};
+        Real maxX{std::numeric_limits<Real>::lowest()};
+        Real maxY{std::numeric_limits<Real>::lowest()};
+        maxRadius = 0;
+        for (size_t i{}; i < n; i++) {
+            minX = std::min(minX, particles.x[i]);
+            maxX = std::max(maxX, particles.x[i]);
+            minY = std::min(minY, particles.y[i]);
+            maxY = std::max(maxY, particles.y[i]);
+            maxRadius = std::max<double>(maxRadius, particles.radius[i]);
+        }
+
+        // Stray particles far outside the scene would otherwise blow up the number of cells
+        cellSize = std::max(2 * maxRadius, MIN_CELL_SIZE);
+        const auto maxCells = static_cast<double>(std::max<size_t>(4 * n, MIN_CELLS));
+        while (std::floor((maxX - minX) / cellSize + 1) * std::floor((maxY - minY) / cellSize + 1) > maxCells)
+            cellSize *= 2;
+
+        invCellSize = 1 / cellSize;
+        originX = minX;
+        originY = minY;
+        cols = static_cast<size_t>((maxX - minX) * invCellSize) + 1;
+        rows = static_cast<size_t>((maxY - minY) * invCellSize) + 1;
+        const auto numCells = cols * rows;
+
+        cellStart.resize(numCells + 1);
+        cellCount.assign(numCells, 0);
+        cellOf.resize(n);
+        sorted.resize(n);
+
+        for (size_t i{}; i < n; i++) {
+            cellOf[i] = static_cast<uint32_t>(cellIndex(particles.x[i], particles.y[i]));
+            cellCount[cellOf[i]]++;
+        }
+
+        uint32_t start{};
+        for (size_t c{}; c < numCells; c++) {
+            cellStart[c] = start;
+            start += cellCount[c];
+            cellCount[c] = 0;
+        }
+        cellStart[numCells] = start;
+
+        for (size_t i{}; i < n; i++) {
+            const auto c = cellOf[i];
+            sorted[cellStart[c] + cellCount[c]++] = static_cast<uint32_t>(i);
+        }
+
+        sleeping = particles.getSleepingCount() > 0;
+        if (sleeping) {
+            const auto& asleep = particles.getSleepMask();
+            cellAwake.assign(numCells, 0);
+            sortedAsleep.resize(n);
+            for (size_t k{}; k < n; k++) {
+                sortedAsleep[k] = asleep[sorted[k]];
+                if (!sortedAsleep[k]) cellAwake[cellOf[sorted[k]]]++;
+            }
+        }
+    }
+
+    // Every pair of particles in the same or neighbouring cells, each pair once with a < b
+    // Each cell is paired with itself and the four neighbours after it so the 3x3 neighbourhood is covered without
+    // visiting any pair of cells twice
+    void findPairs(PairList& pairs) const {
+        if (sleeping)
+            collectPairs<true>(pairs);
+        else
+            collectPairs<false>(pairs);
+    }
+
+    // Calls fn(index) for every particle whose box may overlap the query box, a superset the caller filters
+    // Particles are binned by center so the box is grown by the largest radius before it is mapped to cells
+    template <typename Fn>
+    void queryBox(double minX, double minY, double maxX, double maxY, Fn&& fn) const {
+        if (cols == 0 || rows == 0) return;
+        minX -= maxRadius;
+        minY -= maxRadius;
+        maxX += maxRadius;
+        maxY += maxRadius;
+        if (maxX < originX || maxY < originY) return;
+
+        const auto lastColF = static_cast<double>(cols - 1);
+        const auto lastRowF = static_cast<double>(rows - 1);
+        if ((minX - originX) * invCellSize > lastColF || (minY - originY) * invCellSize > lastRowF) return;
+
+        const auto firstCol = static_cast<size_t>(std::max((minX - originX) * invCellSize, 0.));
+        const auto firstRow = static_cast<size_t>(std::max((minY - originY) * invCellSize, 0.));
+        const auto lastCol = static_cast<size_t>(std::min((maxX - originX) * invCellSize, lastColF));
+        const auto lastRow = static_cast<size_t>(std::min((maxY - originY) * invCellSize, lastRowF));
+
+        for (auto row = firstRow; row <= lastRow; row++) {
+            for (auto col = firstCol; col <= lastCol; col++) {
+                const auto c = row * cols + col;
+                for (auto k = cellStart[c]; k < cellStart[c] + cellCount[c]; k++) fn(sorted[k]);
+            }
+        }
+    }
+
+    // Bound on how far along either axis any particle has moved since the build, a query box grown by it still finds
+    // every particle. The particles have to be the ones the grid was built over, in the same slots.
+    [[nodiscard]] double drift(const ParticleSystem& particles) const {
+        // Most particles have not moved further than the largest distance so far, a rarely taken branch instead of a
+        // max keeps the loop free of a chain through distance
+        Real distance{};
+        for (size_t i{}; i < binnedX.size(); i++) {
+            const auto moved = std::abs(particles.x[i] - binnedX[i]) + std::abs(particles.y[i] - binnedY[i]);
+            if (moved > distance) [[unlikely]]
+                distance = moved;
+        }
+        return distance;
+    }
+
+    [[nodiscard]] double getCellSize() const { return cellSize; }
+    [[nodiscard]] size_t getCols() const { return cols; }
+    [[nodiscard]] size_t getRows() const { return rows; }
+
+   private:
+    static constexpr double MIN_CELL_SIZE{1};
+    static constexpr size_t MIN_CELLS{1024};
+
+    [[nodiscard]] size_t cellIndex(double x, double y) const {
+        const auto col = std::min(static_cast<size_t>(std::max((x - originX) * invCellSize, 0.)), cols - 1);
+        const auto row = std::min(static_cast<size_t>(std::max((y - originY) * invCellSize, 0.)), rows - 1);
+        return row * cols + col;
+    }
+
+    static CandidatePair makePair(uint32_t a, uint32_t b) { return a < b ? CandidatePair{a, b} : CandidatePair{b, a}; }
+
+    // SLEEPING instantiations leave out pairs of sleeping particles, the others emit every pair without looking
+    template <bool SLEEPING>
+    void collectPairs(PairList& pairs) const {
+        pairs.clear();
+        for (size_t row{}; row < rows; row++) {
+            for (size_t col{}; col < cols; col++) {
+                const auto c = row * cols + col;
+                if (cellCount[c] == 0) continue;
+
+                const auto begin = cellStart[c];
+                const auto end = begin + cellCount[c];
+                if (!SLEEPING || cellAwake[c] > 0) {
+                    for (auto i = begin; i < end; i++) {
+                        for (auto j = i + 1; j < end; j++) {
+                            if (!SLEEPING || !sortedAsleep[i] || !sortedAsleep[j])
+                                pairs.push_back(makePair(sorted[i], sorted[j]));
+                        }
+                    }
+                }
+
+                if (col + 1 < cols) pairCells<SLEEPING>(pairs, c, c + 1);
+                if (row + 1 < rows) {
+                    if (col > 0) pairCells<SLEEPING>(pairs, c, c + cols - 1);
+                    pairCells<SLEEPING>(pairs, c, c + cols);
+                    if (col + 1 < cols) pairCells<SLEEPING>(pairs, c, c + cols + 1);
+                }
+            }
+        }
+    }
+
+    template <bool SLEEPING>
+    void pairCells(PairList& pairs, size_t c, size_t other) const {
+        if (cellCount[other] == 0) return;
+        if (SLEEPING && cellAwake[c] == 0 && cellAwake[other] == 0) return;
+        for (auto i = cellStart[c]; i < cellStart[c] + cellCount[c]; i++) {
+            for (auto j = cellStart[other]; j < cellStart[other] + cellCount[other]; j++) {
+                if (!SLEEPING || !sortedAsleep[i] || !sortedAsleep[j]) pairs.push_back(makePair(sorted[i], sorted[j]));
+            }
+        }
+    }
+
+    double cellSize{MIN_CELL_SIZE};
+    double invCellSize{1 / MIN_CELL_SIZE};
+    double originX{};
+    double originY{};
+    double maxRadius{};
+    size_t cols{};
+    size_t rows{};
+
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellCount;
+    std::vector<uint32_t> cellOf;       // Cell of every particle
+    std::vector<uint32_t> sorted;       // Particle indices grouped by cell
+    std::vector<Real> binnedX;          // Positions the particles were binned at
+    std::vector<Real> binnedY;
+    bool sleeping{};                    // Any particle asleep, the two arrays below are only filled then
+    std::vector<uint32_t> cellAwake;    // Awake particles in every cell
+    std::vector<uint8_t> sortedAsleep;  // Sleep flag of every entry of sorted
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cmath>
+
+// Scalar type of the particle data
+// Defining PARTICLE_SINGLE_PRECISION stores and steps particles in float, which halves their memory and the
+// bandwidth of every pass over them, otherwise they are double. Simulation parameters stay double either way.
+#ifdef PARTICLE_SINGLE_PRECISION
+using Real = float;
+#else
+using Real = double;
+#endif
+
+// Two component vector for 2D physics
+// A plain aggregate of two values aligned to their combined size, so a pair loads as one vector register, with
+// constexpr operators, no bounds checks and the squared length for comparisons that do not need the root.
+template <typename T>
+struct alignas(2 * sizeof(T)) Vec2 {
+    T x{};
+    T y{};
+
+    constexpr Vec2 operator+(Vec2 other) const { return {x + other.x, y + other.y}; }
+    constexpr Vec2 operator-(Vec2 other) const { return {x - other.x, y - other.y}; }
+    constexpr Vec2 operator-() const { return {-x, -y}; }
+    constexpr Vec2 operator*(T scale) const { return {x * scale, y * scale}; }
+    constexpr Vec2 operator/(T scale) const { return {x / scale, y / scale}; }
+    constexpr Vec2& operator+=(Vec2 other) { return *this = *this + other; }
+    constexpr Vec2& operator-=(Vec2 other) { return *this = *this - other; }
+    constexpr Vec2& operator*=(T scale) { return *this = *this * scale; }
+    constexpr bool operator==(const Vec2& other) const = default;
+
+    [[nodiscard]] constexpr T dot(Vec2 other) const { return x * other.x + y * other.y; }
+    // z of the 3D cross product, positive when other is counterclockwise from this
+    [[nodiscard]] constexpr T cross(Vec2 other) const { return x * other.y - y * other.x; }
+    [[nodiscard]] constexpr T lengthSq() const { return dot(*this); }
+    [[nodiscard]] T length() const { return std::sqrt(lengthSq()); }
+
+    template <typename U>
+    [[nodiscard]] constexpr Vec2<U> as() const {
+        return {static_cast<U>(x), static_cast<U>(y)};
+    }
+};
+
+template <typename T>
+constexpr Vec2<T> operator*(T scale, Vec2<T> v) {
+    return v * scale;
+}
+
+using Vec2f = Vec2<float>;
+using Vec2d = Vec2<double>;
+using Vec2r = Vec2<Real>;
+
+static_assert(Vec2d{1, 2}.dot({3, 4}) == 11);
+static_assert((Vec2f{3, 4} - Vec2f{1, 1}).lengthSq() == 13);
@@ -0,0 +1,185 @@
+#include "World.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "stopwatch.hpp"
+
+void World::step() {
+    stepCount++;
+    wakeOnChangedSurroundings();
+    particles.savePositions();
+    {
+        Stopwatch stopwatch{phaseTimes.integrate};
+        physics->stepParticles();
+    }
+    {
+        Stopwatch stopwatch{phaseTimes.broadPhase};
+        physics->findCandidatePairs();
+    }
+    {
+        Stopwatch stopwatch{phaseTimes.narrowPhase};
+        physics->resolveCandidatePairs();
+    }
+    {
+        Stopwatch stopwatch{phaseTimes.constraints};
+        springs.solve(particles, physics->dt, physics->parallel ? physics->parallelStep : serialStep);
+    }
+    // This step's collision times are in, pick the method for the next one
+    if (autoBroadPhase) {
+        physics->collisionMethod = broadPhaseSelector.observe(physics->collisionMethod,
+                                                              phaseTimes.broadPhase + phaseTimes.narrowPhase,
+                                                              physics->collisionStats.candidates);
+    }
+    {
+        Stopwatch stopwatch{phaseTimes.sleep};
+        if (sleeping.enabled &&
+            sleepTracker.update(particles, physics->candidatePairs(), springs, sleeping, gravityStep()))
+            wakePending();
+    }
+    {
+        Stopwatch stopwatch{phaseTimes.cull};
+        cullOutOfBoundsParticles();
+        compact();
+    }
+}
+
+void World::addSpring(ParticleHandle first, ParticleHandle second, double restLength, double compliance) {
+    springs.add(first, second, restLength, compliance);
+}
+
+void World::removeParticle(ParticleHandle particle) {
+    const auto i = particles.indexOf(particle);
+    if (i == ParticleSystem::NPOS) return;
+    // What rested on it has to fall
+    if (particles.getSleepingCount() > 0) wake(i);
+    particles.removeAt(i);
+    removeInvalidSprings();
+}
+
+void World::cullOutOfBoundsParticles() {
+    if (!cull) return;
+    const auto xMin = physics->borderXMin;
+    const auto xMax = physics->borderXMax;
+    const auto yMin = physics->borderYMin;
+    const auto yMax = physics->borderYMax;
+    for (size_t i{}; i < particles.size(); i++) {
+        const auto x = particles.x[i];
+        const auto y = particles.y[i];
+        const auto reach = particles.radius[i] + CULL_MARGIN;
+        if (x > xMax + reach || x + reach < xMin || y > yMax + reach || y + reach < yMin) particles.markDead(i);
+    }
+}
+
+void World::purgeParticles(size_t target) {
+    for (auto i = target; i < particles.size(); i++) particles.markDead(i);
+    compact();
+}
+
+void World::compact() {
+    if (particles.getDeadCount() == 0) return;
+    if (particles.getSleepingCount() > 0) {
+        for (size_t i{}; i < particles.size(); i++) {
+            if (particles.isDead(i)) sleepTracker.queueWake(i);
+        }
+        wakePending();
+    }
+    particles.compact();
+    removeInvalidSprings();
+}
+
+void World::removeInvalidSprings() {
+    springs.removeInvalid(particles);
+}
+
+void World::wake(size_t i) {
+    if (particles.getSleepingCount() == 0) return;
+    sleepTracker.queueWake(i);
+    wakePending();
+}
+
+void World::wakeAll() {
+    sleepTracker.wakeAll(particles);
+}
+
+double World::gravityStep() const {
+    return physics->gravity.length() * physics->dt;
+}
+
+void World::wakeOnChangedSurroundings() {
+    const auto params = physics->stepParams();
+    const auto changed = params.gravityX != surroundings.gravityX || params.gravityY != surroundings.gravityY ||
+                         params.xMin != surroundings.xMin || params.xMax != surroundings.xMax ||
+                         params.yMin != surroundings.yMin || params.yMax != surroundings.yMax;
+    surroundings = params;
+    if (particles.getSleepingCount() > 0 && (!sleeping.enabled || changed)) wakeAll();
+}
+
+void World::wakePending() {
+    const auto [index, drift] = spatialIndex();
+    sleepTracker.wakePending(particles, springs, index, drift);
+}
+
+std::pair<const UniformGrid&, double> World::spatialIndex() {
+    // The narrow phase and the springs push particles after the broad-phase binned them, queries look as far out as
+    // they were pushed. Only the step moves particles, the distance is measured once after each.
+    if (const auto* grid = physics->broadPhaseGrid()) {
+        if (driftStep != stepCount) {
+            gridDrift = grid->drift(particles);
+            driftStep = stepCount;
+        }
+        return {*grid, gridDrift};
+    }
+    if (indexStep != stepCount || indexLayout != particles.getLayoutVersion()) {
+        index.build(particles);
+        indexStep = stepCount;
+        indexLayout = particles.getLayoutVersion();
+    }
+    return {index, 0};
+}
+
+template <typename Fn>
+void World::queryBox(double minX, double minY, double maxX, double maxY, Fn&& fn) {
+    const auto [grid, drift] = spatialIndex();
+    grid.queryBox(minX - drift, minY - drift, maxX + drift, maxY + drift, std::forward<Fn>(fn));
+}
+
+size_t World::pickAt(double x, double y, double slack) {
+    auto best = ParticleSystem::NPOS;
+    auto bestDistSq = std::numeric_limits<double>::max();
+    queryBox(x - slack, y - slack, x + slack, y + slack, [&](size_t i) {
+        const auto reach = particles.radius[i] + slack;
+        const auto dx = particles.x[i] - x;
+        const auto dy = particles.y[i] - y;
+        if (std::abs(dx) > reach || std::abs(dy) > reach) return;
+        const auto distSq = dx * dx + dy * dy;
+        if (distSq < bestDistSq || (distSq == bestDistSq && i < best)) {
+            best = i;
+            bestDistSq = distSq;
+        }
+    });
+    return best;
+}
+
+void World::queryCircle(double x, double y, double radius, std::vector<size_t>& out) {
+    const auto radiusSq = radius * radius;
+    queryBox(x - radius, y - radius, x + radius, y + radius, [&](size_t i) {
+        const auto dx = particles.x[i] - x;
+        const auto dy = particles.y[i] - y;
+        if (dx * dx + dy * dy <= radiusSq) out.push_back(i);
+    });
+}
+
+void World::queryRect(double x0, double y0, double x1, double y1, std::vector<size_t>& out) {
+    const auto minX = std::min(x0, x1);
+    const auto maxX = std::max(x0, x1);
+    const auto minY = std::min(y0, y1);
+    const auto maxY = std::max(y0, y1);
+    queryBox(minX, minY, maxX, maxY, [&](size_t i) {
+        const auto x = particles.x[i];
+        const auto y = particles.y[i];
+        if (minX <= x && x <= maxX && minY <= y && y <= maxY) out.push_back(i);
+    });
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "BroadPhaseSelector.hpp"
+#include "DistanceConstraints.hpp"
+#include "ParticleSystem.hpp"
+#include "Physics.hpp"
+#include "SleepTracker.hpp"
+#include "UniformGrid.hpp"
+
+// Time spent in each phase of the last step
+struct PhaseTimes {
+    std::chrono::nanoseconds integrate{};
+    std::chrono::nanoseconds broadPhase{};
+    std::chrono::nanoseconds narrowPhase{};
+    std::chrono::nanoseconds constraints{};
+    std::chrono::nanoseconds sleep{};
+    std::chrono::nanoseconds cull{};
+
+    [[nodiscard]] std::chrono::nanoseconds total() const {
+        return integrate + broadPhase + narrowPhase + constraints + sleep + cull;
+    }
+};
+
+// The simulation without any window or UI
+// Owns the particles, the springs between them and the physics that moves them. Screen draws a World and the
+// headless benchmarks step one directly.
+class World {
+   public:
+    World() = default;
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    // Moves the simulation forward by physics->dt
+    void step();
+
+    void addSpring(ParticleHandle first, ParticleHandle second, double restLength = 5,
+                   double compliance = DistanceConstraints::DEFAULT_COMPLIANCE);
+    void removeParticle(ParticleHandle particle);
+    // Marks particles that left the border by more than their radius plus a margin as dead
+    void cullOutOfBoundsParticles();
+    // Removes every particle past the first target
+    void purgeParticles(size_t target);
+    // Removes the particles marked dead and the springs attached to them, once per step after culling
+    void compact();
+    // Drops springs attached to a particle that no longer exists
+    void removeInvalidSprings();
+
+    // Wakes the particle and every sleeping particle connected to it, for when something other than the step moves
+    // or pushes it
+    void wake(size_t i);
+    void wakeAll();
+
+    // Picking and region selection
+    // Served by the grid the broad-phase built this step when physics->collisionMethod is UNI_SPACE_PART and no
+    // particle was added or removed since, otherwise by a grid of its own rebuilt on the first query after either.
+    // Each query only looks at the particles near it.
+
+    // The particle whose box contains the point grown by slack and whose center is closest to it, or NPOS
+    [[nodiscard]] size_t pickAt(double x, double y, double slack = 0);
+    // Appends every particle whose center lies within radius of the point
+    void queryCircle(double x, double y, double radius, std::vector<size_t>& out);
+    // Appends every particle whose center lies inside the rectangle, the corners may come in any order
+    void queryRect(double x0, double y0, double x1, double y1, std::vector<size_t>& out);
+
+    [[nodiscard]] const PhaseTimes& getPhaseTimes() const { return phaseTimes; }
+    [[nodiscard]] const BroadPhaseSelector& getBroadPhaseSelector() const { return broadPhaseSelector; }
+
+    ParticleSystem particles;
+    DistanceConstraints springs;
+    PhysicsType physics{new SimplePhysics(0.0, particles)};
+    bool cull{};
+    SleepSettings sleeping;
+    // Lets broadPhaseSelector pick physics->collisionMethod after every step
+    bool autoBroadPhase{};
+
+   private:
+    static constexpr double CULL_MARGIN{10};
+
+    // Grid to serve queries from and how far particles may have moved from where it binned them
+    std::pair<const UniformGrid&, double> spatialIndex();
+    // Calls fn(index) for a superset of the particles whose box overlaps the query box
+    template <typename Fn>
+    void queryBox(double minX, double minY, double maxX, double maxY, Fn&& fn);
+    // Speed one step of gravity adds to a particle of unit mass
+    [[nodiscard]] double gravityStep() const;
+    // Sleeping particles do not notice the walls or gravity changing, everything wakes when they do
+    void wakeOnChangedSurroundings();
+    void wakePending();
+
+    PhaseTimes phaseTimes;
+    SleepTracker sleepTracker;
+    BroadPhaseSelector broadPhaseSelector;
+    kernels::StepParams surroundings{};  // Step parameters of the last step
+    ParallelStep serialStep{1};  // Constraints when physics->parallel is off
+    UniformGrid index;
+    size_t stepCount{};
+    // Step and particle layout index was built at, never matches before the first build
+    size_t indexStep{std::numeric_limits<size_t>::max()};
+    uint64_t indexLayout{};
+    // How far particles moved from where physics->broadPhaseGrid() binned them, measured at driftStep
+    size_t driftStep{std::numeric_limits<size_t>::max()};
+    double gridDrift{};
+};
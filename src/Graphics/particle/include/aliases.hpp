@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Broad-phase candidate, indices into the ParticleSystem arrays with a < b
+struct CandidatePair {
+    uint32_t a;
+    uint32_t b;
+};
+using PairList = std::vector<CandidatePair>;
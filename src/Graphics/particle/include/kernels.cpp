@@ -0,0 +1,250 @@
+#include "kernels.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#endif
+
+namespace kernels {
+
+    namespace {
+        // SLEEPING instantiations leave sleeping particles untouched, the others step every particle without looking
+        // at the sleep mask
+        template <bool SLEEPING>
+        void stepScalar(ParticleSystem& p, const StepParams& s, size_t first, size_t last) {
+            const auto restitution = 1 + s.elasticity;
+            const auto* asleep = p.getSleepMask().data();
+            for (size_t i{first}; i < last; i++) {
+                if constexpr (SLEEPING) {
+                    if (asleep[i]) continue;
+                }
+                auto x = p.x[i];
+                auto y = p.y[i];
+                auto vx = p.vx[i];
+                auto vy = p.vy[i];
+                const auto r = p.radius[i];
+                const auto m = p.mass[i];
+
+                // Each wall reflects the normal component and applies friction to the tangential one, walls are
+                // resolved one after another so a particle in a corner bounces off both
+                if (x - r <= s.xMin && vx < 0) {
+                    vx = vx - restitution * vx;
+                    vy = vy - s.friction * vy * s.dt;
+                    x = x + (s.xMin - (x - r));
+                }
+                if (x + r >= s.xMax && vx > 0) {
+                    vx = vx - restitution * vx;
+                    vy = vy - s.friction * vy * s.dt;
+                    x = x - ((x - r) - s.xMax + r * 2);
+                }
+                if (y + r >= s.yMax && vy > 0) {
+                    vy = vy - restitution * vy;
+                    vx = vx - s.friction * vx * s.dt;
+                    y = y - ((y - r) - s.yMax + r * 2);
+                }
+                if (y - r <= s.yMin && vy < 0) {
+                    vy = vy - restitution * vy;
+                    vx = vx - s.friction * vx * s.dt;
+                    y = y + (s.yMin - (y - r));
+                }
+
+                // Euler's method
+                vx = vx + s.gravityX * m * s.dt;
+                vy = vy + s.gravityY * m * s.dt;
+                p.x[i] = x + vx * s.dt;
+                p.y[i] = y + vy * s.dt;
+                p.vx[i] = vx;
+                p.vy[i] = vy;
+            }
+        }
+
+#ifdef KERNELS_X86
+        // Vectors of Real as GCC vector extensions, the same code steps 2 or 4 doubles, or 4 or 8 floats, at a time
+        // and the arithmetic is the same IEEE operations as the scalar loop. Lanes compare to masks of all ones.
+        using Lanes128 = Real __attribute__((vector_size(16)));
+        using Lanes256 = Real __attribute__((vector_size(32)));
+
+        // Vectors are only passed by reference, by value the 32 byte ones would depend on the caller's instruction set
+        template <typename V>
+        [[gnu::always_inline]] inline void load(V& to, const Real* from) {
+            std::memcpy(&to, from, sizeof(V));
+        }
+
+        template <typename V>
+        [[gnu::always_inline]] inline void store(Real* to, const V& from) {
+            std::memcpy(to, &from, sizeof(V));
+        }
+
+        // One sleep byte per lane, up to 8 lanes
+        constexpr uint64_t ALL_ASLEEP{0x0101010101010101};
+
+        template <typename Mask>
+        [[gnu::always_inline]] inline bool any(const Mask& mask) {
+            constexpr auto width = sizeof(Mask) / sizeof(mask[0]);
+            return [&]<size_t... lane>(std::index_sequence<lane...>) {
+                return (mask[lane] | ...) != 0;
+            }(std::make_index_sequence<width>{});
+        }
+
+        // Steps whole vectors of particles from i and leaves i at the first particle it did not step. Inlined into
+        // the caller so the vectors are compiled for the caller's instruction set.
+        template <typename V, bool SLEEPING>
+        [[gnu::always_inline]] inline void stepLanes(ParticleSystem& p, const StepParams& s, size_t& i, size_t last) {
+            constexpr auto width = sizeof(V) / sizeof(Real);
+            const auto* asleep = p.getSleepMask().data();
+            // Adding a scalar to a vector broadcasts it to every lane
+            const V zero{};
+            const V two = zero + 2;
+            const V dt = zero + s.dt;
+            const V restitution = zero + (1 + s.elasticity);
+            const V friction = zero + s.friction;
+            const V gx = zero + s.gravityX;
+            const V gy = zero + s.gravityY;
+            const V xMin = zero + s.xMin;
+            const V xMax = zero + s.xMax;
+            const V yMin = zero + s.yMin;
+            const V yMax = zero + s.yMax;
+
+            for (; i + width <= last; i += width) {
+                // Vectors of only sleeping particles are skipped, mixed ones are stepped whole and the sleeping lanes
+                // written back unchanged
+                [[maybe_unused]] uint64_t sleepBytes{};
+                [[maybe_unused]] V sleeping;
+                if constexpr (SLEEPING) {
+                    std::memcpy(&sleepBytes, &asleep[i], width);
+                    if (sleepBytes == ALL_ASLEEP >> (64 - 8 * width)) continue;
+                    [&]<size_t... lane>(std::index_sequence<lane...>) {
+                        ((sleeping[lane] = asleep[i + lane]), ...);
+                    }(std::make_index_sequence<width>{});
+                }
+
+                V x, y, vx, vy, r, m;
+                load(x, &p.x[i]);
+                load(y, &p.y[i]);
+                load(vx, &p.vx[i]);
+                load(vy, &p.vy[i]);
+                load(r, &p.radius[i]);
+                load(m, &p.mass[i]);
+
+                // Walls only move a particle that already touches one, so lanes away from every wall skip them
+                const auto nearX = (x - r <= xMin) | (x + r >= xMax);
+                const auto nearY = (y - r <= yMin) | (y + r >= yMax);
+                if (any(nearX | nearY)) {
+                    // Left wall
+                    auto hit = (x - r <= xMin) & (vx < zero);
+                    auto nvx = vx - restitution * vx;
+                    auto nvy = vy - friction * vy * dt;
+                    vx = hit ? nvx : vx;
+                    vy = hit ? nvy : vy;
+                    x = hit ? x + (xMin - (x - r)) : x;
+
+                    // Right wall
+                    hit = (x + r >= xMax) & (vx > zero);
+                    nvx = vx - restitution * vx;
+                    nvy = vy - friction * vy * dt;
+                    vx = hit ? nvx : vx;
+                    vy = hit ? nvy : vy;
+                    x = hit ? x - ((x - r) - xMax + r * two) : x;
+
+                    // Bottom wall
+                    hit = (y + r >= yMax) & (vy > zero);
+                    nvy = vy - restitution * vy;
+                    nvx = vx - friction * vx * dt;
+                    vx = hit ? nvx : vx;
+                    vy = hit ? nvy : vy;
+                    y = hit ? y - ((y - r) - yMax + r * two) : y;
+
+                    // Top wall
+                    hit = (y - r <= yMin) & (vy < zero);
+                    nvy = vy - restitution * vy;
+                    nvx = vx - friction * vx * dt;
+                    vx = hit ? nvx : vx;
+                    vy = hit ? nvy : vy;
+                    y = hit ? y + (yMin - (y - r)) : y;
+                }
+
+                vx = vx + gx * m * dt;
+                vy = vy + gy * m * dt;
+                x = x + vx * dt;
+                y = y + vy * dt;
+                if constexpr (SLEEPING) {
+                    if (sleepBytes != 0) {
+                        V x0, y0, vx0, vy0;
+                        load(x0, &p.x[i]);
+                        load(y0, &p.y[i]);
+                        load(vx0, &p.vx[i]);
+                        load(vy0, &p.vy[i]);
+                        const auto stepped = sleeping == zero;
+                        x = stepped ? x : x0;
+                        y = stepped ? y : y0;
+                        vx = stepped ? vx : vx0;
+                        vy = stepped ? vy : vy0;
+                    }
+                }
+                store(&p.x[i], x);
+                store(&p.y[i], y);
+                store(&p.vx[i], vx);
+                store(&p.vy[i], vy);
+            }
+        }
+
+        template <bool SLEEPING>
+        void stepSse2(ParticleSystem& p, const StepParams& s, size_t first, size_t last) {
+            size_t i{first};
+            stepLanes<Lanes128, SLEEPING>(p, s, i, last);
+            stepScalar<SLEEPING>(p, s, i, last);
+        }
+
+        // Same as stepSse2 with twice the lanes, compiled for AVX2 only and called after checking the CPU
+        template <bool SLEEPING>
+        __attribute__((target("avx2"))) void stepAvx2(ParticleSystem& p, const StepParams& s, size_t first,
+                                                      size_t last) {
+            size_t i{first};
+            stepLanes<Lanes256, SLEEPING>(p, s, i, last);
+            stepScalar<SLEEPING>(p, s, i, last);
+        }
+#endif
+    }  // namespace
+
+    namespace {
+        template <bool SLEEPING>
+        void step(Isa isa, ParticleSystem& p, const StepParams& s, size_t first, size_t last) {
+#ifdef KERNELS_X86
+            if (isa == Isa::AVX2 && detectIsa() == Isa::AVX2) return stepAvx2<SLEEPING>(p, s, first, last);
+            if (isa != Isa::SCALAR) return stepSse2<SLEEPING>(p, s, first, last);
+#endif
+            stepScalar<SLEEPING>(p, s, first, last);
+        }
+    }  // namespace
+
+    Isa detectIsa() {
+#ifdef KERNELS_X86
+        if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+        return Isa::SSE2;
+#else
+        return Isa::SCALAR;
+#endif
+    }
+
+    std::string_view isaName(Isa isa) {
+        switch (isa) {
+            case Isa::SCALAR:
+                return "scalar";
+            case Isa::SSE2:
+                return "SSE2";
+            case Isa::AVX2:
+                return "AVX2";
+        }
+        return "unknown";
+    }
+
+    void integrateAndCollideWalls(Isa isa, ParticleSystem& particles, const StepParams& params, size_t first,
+                                  size_t last) {
+        if (particles.getSleepingCount() > 0) return step<true>(isa, particles, params, first, last);
+        step<false>(isa, particles, params, first, last);
+    }
+
+}  // namespace kernels
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "ParticleSystem.hpp"
+
+// Batch kernels over the ParticleSystem arrays
+// Every kernel has a scalar version and, on x86, SSE2 and AVX2 versions picked at runtime from what the CPU
+// supports. The vector versions perform the same floating point operations in the same order as the scalar one so
+// all of them produce bit identical results.
+namespace kernels {
+
+    enum class Isa { SCALAR = 0, SSE2, AVX2 };
+
+    // In the precision of the particles so every version computes in Real
+    struct StepParams {
+        Real dt;
+        Real gravityX;
+        Real gravityY;
+        Real elasticity;
+        Real friction;
+        Real xMin;
+        Real xMax;
+        Real yMin;
+        Real yMax;
+    };
+
+    // Best instruction set supported by the running CPU
+    Isa detectIsa();
+    std::string_view isaName(Isa isa);
+
+    // Resolves collisions with the four walls, then advances velocity and position by one Euler step, for the
+    // particles in [first, last) that are awake
+    void integrateAndCollideWalls(Isa isa, ParticleSystem& particles, const StepParams& params, size_t first,
+                                  size_t last);
+
+    inline void integrateAndCollideWalls(ParticleSystem& particles, const StepParams& params, size_t first,
+                                         size_t last) {
+        static const Isa isa{detectIsa()};
+        integrateAndCollideWalls(isa, particles, params, first, last);
+    }
+
+    inline void integrateAndCollideWalls(ParticleSystem& particles, const StepParams& params) {
+        integrateAndCollideWalls(particles, params, 0, particles.size());
+    }
+
+}  // namespace kernels
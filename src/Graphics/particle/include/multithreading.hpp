@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "aliases.hpp"
+#include "kernels.hpp"
+#include "thread_pool.hpp"
+
+// Greedy edge coloring of a list of pairs
+// Every pair takes the lowest color neither of its two vertices uses yet, in pair order, so no two pairs of the same
+// color share a vertex and the pairs of one color can be processed in parallel. Vertices track their colors in a 64
+// bit mask, a pair whose vertices have used up all 64 goes to an overflow bucket whose pairs may share vertices.
+class EdgeColoring {
+   public:
+    static constexpr size_t OVERFLOW_COLOR{64};
+
+    // Vertices are the values in the pairs and must be less than vertexCount
+    void color(const PairList& pairs, size_t vertexCount) {
+        usedColors.assign(vertexCount, 0);
+        colorOf.resize(pairs.size());
+        colorStart.assign(OVERFLOW_COLOR + 2, 0);
+
+        for (size_t k{}; k < pairs.size(); k++) {
+            const auto [a, b] = pairs[k];
+            const auto free = ~(usedColors[a] | usedColors[b]);
+            const auto c = free == 0 ? OVERFLOW_COLOR : static_cast<size_t>(std::countr_zero(free));
+            if (c != OVERFLOW_COLOR) {
+                usedColors[a] |= uint64_t{1} << c;
+                usedColors[b] |= uint64_t{1} << c;
+            }
+            colorOf[k] = static_cast<uint8_t>(c);
+            colorStart[c + 1]++;
+        }
+
+        usedColorCount = 0;
+        for (size_t c{}; c <= OVERFLOW_COLOR; c++) {
+            if (colorStart[c + 1] > 0) usedColorCount = c + 1;
+            colorStart[c + 1] += colorStart[c];
+        }
+
+        // Stable counting sort so each color keeps the pair order
+        order.resize(pairs.size());
+        cursor.assign(colorStart.begin(), colorStart.end() - 1);
+        for (size_t k{}; k < pairs.size(); k++) order[cursor[colorOf[k]]++] = k;
+    }
+
+    // Pair indices grouped by color, color c is [colorBegin(c), colorEnd(c)) of this
+    [[nodiscard]] const std::vector<size_t>& getOrder() const { return order; }
+    [[nodiscard]] size_t colorBegin(size_t c) const { return colorStart[c]; }
+    [[nodiscard]] size_t colorEnd(size_t c) const { return colorStart[c + 1]; }
+    // Colors used, including the overflow bucket when it was needed
+    [[nodiscard]] size_t getColorCount() const { return usedColorCount; }
+
+   private:
+    std::vector<uint64_t> usedColors;  // Per vertex mask of the colors its pairs took
+    std::vector<uint8_t> colorOf;
+    std::vector<size_t> colorStart;
+    std::vector<size_t> cursor;
+    std::vector<size_t> order;
+    size_t usedColorCount{};
+};
+
+// Runs the per particle parts of the physics step on a thread pool
+// Integration is a parallel for over blocks of particles. Collision pairs are edge colored so that no two pairs of the
+// same color share a particle, the colors are resolved one after the other and the pairs of one color in parallel.
+// The coloring only depends on the pair list so the result is the same for any number of threads.
+class ParallelStep {
+   public:
+    static constexpr size_t RESOLVE_GRAIN{1024};
+
+    // The calling thread works too, so a step with n threads starts n - 1 workers
+    explicit ParallelStep(size_t threads) { setThreads(threads); }
+
+    void setThreads(size_t threads) {
+        threads = std::max<size_t>(threads, 1);
+        if (threads == getThreads()) return;
+        pool = threads > 1 ? std::make_unique<mts::concurrency::ThreadPool>(threads - 1) : nullptr;
+    }
+
+    [[nodiscard]] size_t getThreads() const { return pool ? pool->size() + 1 : 1; }
+
+    void integrate(ParticleSystem& particles, const kernels::StepParams& params) {
+        forBlocks(particles.size(), INTEGRATE_GRAIN, [&](size_t first, size_t last) {
+            kernels::integrateAndCollideWalls(particles, params, first, last);
+        });
+    }
+
+    // Calls resolve(pairs) on runs of pairs that share no particle and returns the sum of what it returns
+    template <typename Resolve>
+    size_t resolvePairs(const PairList& pairs, size_t particleCount, Resolve&& resolve) {
+        coloring.color(pairs, particleCount);
+        colored.resize(pairs.size());
+        const auto& order = coloring.getOrder();
+        for (size_t k{}; k < pairs.size(); k++) colored[k] = pairs[order[k]];
+
+        std::atomic<size_t> total{};
+        forEachColor(coloring, [&](size_t first, size_t last) {
+            const std::span<const CandidatePair> batch{colored.data() + first, last - first};
+            total.fetch_add(resolve(batch), std::memory_order_relaxed);
+        });
+        return total;
+    }
+
+    // Calls fn(first, last) over ranges of positions in the coloring order, the colors one after the other and the
+    // positions of one color in parallel. The overflow bucket runs in order on the calling thread.
+    template <typename Fn>
+    void forEachColor(const EdgeColoring& colors, Fn&& fn, size_t grain = RESOLVE_GRAIN) {
+        for (size_t c{}; c < colors.getColorCount(); c++) {
+            const auto first = colors.colorBegin(c);
+            const auto last = colors.colorEnd(c);
+            if (first == last) continue;
+            if (c == EdgeColoring::OVERFLOW_COLOR) {
+                fn(first, last);
+                continue;
+            }
+            forBlocks(last - first, grain,
+                      [&](size_t blockFirst, size_t blockLast) { fn(first + blockFirst, first + blockLast); });
+        }
+    }
+
+    // Colors used by the last resolvePairs, including the overflow bucket when it was needed
+    [[nodiscard]] size_t getColorCount() const { return coloring.getColorCount(); }
+
+   private:
+    static constexpr size_t INTEGRATE_GRAIN{4096};
+
+    template <typename Fn>
+    void forBlocks(size_t count, size_t grain, Fn&& fn) {
+        if (!pool) {
+            if (count > 0) fn(size_t{0}, count);
+            return;
+        }
+        mts::concurrency::parallel_for_blocks(*pool, size_t{0}, count, grain, fn);
+    }
+
+    std::unique_ptr<mts::concurrency::ThreadPool> pool;
+    EdgeColoring coloring;
+    PairList colored;
+};
@@ -0,0 +1,63 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+#include "ParticleSystem.hpp"
+#include "Physics.hpp"
+#include "bench_scene.hpp"
+#include "kernels.hpp"
+#include "stopwatch.hpp"
+
+// Headless benchmark of the wall collision and integration step
+// Runs the per particle SimplePhysics path and the batch kernel on every instruction set the CPU supports from the
+// same seeded scene, checks the results are bit identical and reports particles per second
+
+using namespace std;
+
+// Some particles start past the walls so every step has wall hits to resolve
+const Vec2d SCENE_MIN{-20, -20};
+const Vec2d SCENE_MAX{WIDTH + 20, HEIGHT + 20};
+const SceneRanges SCENE_RANGES{.maxSpeed = 200, .minMass = 2, .maxMass = 10};
+
+void report(string_view name, size_t n, size_t steps, chrono::nanoseconds elapsed, bool matches) {
+    const auto seconds = chrono::duration<double>(elapsed).count();
+    const auto rate = static_cast<double>(n * steps) / seconds;
+    cout << format("{:<10} {:>8} particles {:>5} steps {:>10.2f} ms {:>8.1f} M particles/s {}\n", name, n, steps,
+                   seconds * 1e3, rate / 1e6, matches ? "" : "MISMATCH");
+}
+
+int main() {
+    const auto best = kernels::detectIsa();
+    cout << format("Best supported instruction set: {}, {} precision\n", kernels::isaName(best),
+                   sizeof(Real) == sizeof(float) ? "single" : "double");
+
+    for (const size_t n : {100'000, 1'000'000}) {
+        const size_t steps{max<size_t>(1, 20'000'000 / n)};
+
+        auto reference = makeScene(n, SCENE_MIN, SCENE_MAX, SCENE_RANGES);
+        SimplePhysics physics{1. / 60, reference, 0, WIDTH, 0, HEIGHT};
+        physics.gravity = {0, 9.8};
+
+        chrono::nanoseconds elapsed{};
+        {
+            Stopwatch stopwatch{elapsed};
+            for (size_t step{}; step < steps; step++) physics.Physics::stepParticles();
+        }
+        report("reference", n, steps, elapsed, true);
+
+        for (auto isa : {kernels::Isa::SCALAR, kernels::Isa::SSE2, kernels::Isa::AVX2}) {
+            if (static_cast<int>(isa) > static_cast<int>(best)) continue;
+
+            auto particles = makeScene(n, SCENE_MIN, SCENE_MAX, SCENE_RANGES);
+            const auto params = physics.stepParams();
+            {
+                Stopwatch stopwatch{elapsed};
+                for (size_t step{}; step < steps; step++)
+                    kernels::integrateAndCollideWalls(isa, particles, params, 0, particles.size());
+            }
+            report(kernels::isaName(isa), n, steps, elapsed, sameState(reference, particles));
+        }
+        cout << '\n';
+    }
+}
@@ -0,0 +1,57 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ParticleSystem.hpp"
+#include "Physics.hpp"
+#include "bench_scene.hpp"
+#include "stopwatch.hpp"
+
+// Headless benchmark of the parallel physics step
+// Runs the same seeded 10^5 particle scene with the parallel step on 1 up to the hardware thread count, or up to the
+// count given as the first argument, reports the time per frame and the speedup over one thread and checks every run
+// ends in the same state
+
+using namespace std;
+
+const size_t PARTICLES{100'000};
+const size_t FRAMES{60};
+
+int main(int argc, char** argv) {
+    const auto box = windowBox(PARTICLES);
+
+    const auto maxThreads = max<size_t>(argc > 1 ? stoul(argv[1]) : thread::hardware_concurrency(), 1);
+    vector<size_t> threadCounts;
+    for (size_t threads{1}; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    ParticleSystem reference;
+    double baseline{};
+    for (const auto threads : threadCounts) {
+        auto particles = makeScene(PARTICLES, {0, 0}, box);
+        SimplePhysics physics{1. / 60, particles, 0, static_cast<float>(box.x), 0, static_cast<float>(box.y)};
+        physics.gravity = {0, 9.8};
+        physics.parallel = true;
+        physics.parallelStep.setThreads(threads);
+
+        chrono::nanoseconds elapsed{};
+        {
+            Stopwatch stopwatch{elapsed};
+            for (size_t frame{}; frame < FRAMES; frame++) {
+                physics.stepParticles();
+                physics.handleParticleCollision();
+            }
+        }
+
+        const auto ms = chrono::duration<double, milli>(elapsed).count() / FRAMES;
+        if (threads == 1) {
+            baseline = ms;
+            reference = particles;
+        }
+        cout << format("{:>3} threads {:>9.3f} ms/frame {:>6.2f}x {:>3} colors {}\n", threads, ms, baseline / ms,
+                       physics.parallelStep.getColorCount(), sameState(reference, particles) ? "" : "MISMATCH");
+    }
+}
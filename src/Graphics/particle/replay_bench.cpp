@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Physics.hpp"
+#include "Recording.hpp"
+#include "stopwatch.hpp"
+
+// Headless replay of recordings
+// Given one recording it loads every frame and times each broad-phase on it, so the methods are compared on exactly
+// the same workload. Given two it compares them frame by frame and reports where the particles first drift apart,
+// to diff the physics output of two builds or settings. Particles are matched by slot so both runs must have added
+// them in the same order, as two sim_bench runs with the same seed do.
+// Usage: replay_bench <recording> [other recording]
+
+using namespace std;
+
+void benchBroadPhases(Player& player) {
+    const vector<CollisionDetection> methods{
+        CollisionDetection::SWEEP_AND_PRUNE,
+        CollisionDetection::SWEEP_AND_PRUNE_DUAL_AXIS,
+        CollisionDetection::UNI_SPACE_PART,
+        CollisionDetection::KD_TREE,
+        CollisionDetection::BVH_TREE,
+    };
+
+    const auto frames = player.getFrameCount();
+    cout << format("{} frames, {} particles in the first\n", frames, (player.seek(0), player.size()));
+    for (const auto method : methods) {
+        ParticleSystem particles;
+        SimplePhysics physics{0, particles};
+        physics.collisionMethod = method;
+
+        chrono::nanoseconds elapsed{};
+        size_t pairs{};
+        for (size_t frame{}; frame < frames; frame++) {
+            player.seek(frame);
+            player.copyTo(particles);
+            chrono::nanoseconds frameTime{};
+            {
+                Stopwatch stopwatch{frameTime};
+                physics.findCandidatePairs();
+            }
+            elapsed += frameTime;
+            pairs += physics.candidatePairs().size();
+        }
+
+        const auto ms = chrono::duration<double, milli>(elapsed).count() / static_cast<double>(frames);
+        cout << format("  {:<30} {:>9.3f} ms/frame {:>12} pairs in total\n", parseCollisionMethods(method), ms, pairs);
+    }
+}
+
+int diff(Player& a, Player& b) {
+    // Quantized recordings are only exact to within half a quantum per coordinate
+    const auto tolerance = (a.getQuantum() + b.getQuantum()) / 2;
+    const auto frames = min(a.getFrameCount(), b.getFrameCount());
+    if (a.getFrameCount() != b.getFrameCount())
+        cout << format("Frame counts differ, {} and {}, comparing the first {}\n", a.getFrameCount(),
+                       b.getFrameCount(), frames);
+
+    double worst{};
+    size_t worstFrame{};
+    size_t firstFrame{frames};
+    for (size_t frame{}; frame < frames; frame++) {
+        a.seek(frame);
+        b.seek(frame);
+        if (a.size() != b.size()) {
+            cout << format("Frame {}: {} particles against {}\n", frame, a.size(), b.size());
+            return 1;
+        }
+        double distance{};
+        for (size_t i{}; i < a.size(); i++) distance = max({distance, abs(a.x[i] - b.x[i]), abs(a.y[i] - b.y[i])});
+        if (distance > tolerance && firstFrame == frames) firstFrame = frame;
+        if (distance > worst) {
+            worst = distance;
+            worstFrame = frame;
+        }
+    }
+
+    if (firstFrame == frames) {
+        cout << format("{} frames match\n", frames);
+        return 0;
+    }
+    cout << format("Recordings differ from frame {}, largest coordinate difference {} at frame {}\n", firstFrame, worst,
+                   worstFrame);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: replay_bench <recording> [other recording]\n";
+        return 1;
+    }
+    try {
+        Player player{argv[1]};
+        if (argc < 3) {
+            benchBroadPhases(player);
+            return 0;
+        }
+        Player other{argv[2]};
+        return diff(player, other);
+    } catch (const exception& e) {
+        cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -11,11 +11,12 @@ const int WINX{1366};
 const int WINY{768};
 
 const int FPS = 60;
+const int SUBSTEPS = 2;  // Physics steps per rendered frame
 const int DELAY_TIME = static_cast<int>(1000 / FPS);
 
 int main() {
     try {
-        if (!ParticleScreen::Instance()->init("Simulation", {WINX, WINY}, false, 1. / FPS, FPS)) return 1;
+        if (!ParticleScreen::Instance()->init("Simulation", {WINX, WINY}, false, SUBSTEPS, FPS)) return 1;
 
         while (ParticleScreen::Instance()->isRunning()) {
             ParticleScreen::Instance()->restartClock();
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "Recording.hpp"
+#include "World.hpp"
+#include "bench_scene.hpp"
+
+// Headless benchmark of a full simulation step
+// Builds a seeded scene of particles falling under gravity with springs between some neighbours, steps it a fixed
+// number of frames and reports the time per step of every phase. Given a path it also records every step there, for
+// replay_bench to run the broad-phases on or to diff against another run.
+// Usage: sim_bench [particles] [frames] [seed] [recording] [quantum]
+
+using namespace std;
+
+const size_t SPRING_EVERY{10};
+// Positions, previous positions, velocities, mass and radius plus the color, what every step streams through
+const size_t PARTICLE_BYTES{8 * sizeof(Real) + sizeof(Color)};
+
+void makeScene(World& world, size_t n, unsigned seed) {
+    const auto box = windowBox(n);
+    auto& particles = world.particles;
+    scatterScene(particles, n, {0, 0}, box, {.seed = seed});
+
+    // Every SPRING_EVERY-th particle is moved next to the one before it and tied to it by a spring
+    mt19937_64 rng{seed};
+    uniform_real_distribution<double> rngOffset{-10, 10};
+    for (size_t i{1}; i < n; i += SPRING_EVERY) {
+        particles.x[i] = particles.x[i - 1] + static_cast<Real>(rngOffset(rng));
+        particles.y[i] = particles.y[i - 1] + static_cast<Real>(rngOffset(rng));
+        world.addSpring(particles.handleAt(i - 1), particles.handleAt(i), 15);
+    }
+
+    world.physics->setWinDim(0, static_cast<float>(box.x), 0, static_cast<float>(box.y));
+    world.physics->dt = 1. / 60;
+    world.physics->gravity = {0, 9.8};
+    world.cull = true;
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? stoul(argv[1]) : 100'000;
+    const size_t frames = argc > 2 ? stoul(argv[2]) : 100;
+    const unsigned seed = argc > 3 ? stoul(argv[3]) : 42;
+    unique_ptr<Recorder> recorder;
+    if (argc > 4) recorder = make_unique<Recorder>(argv[4], RecordingOptions{.quantum = argc > 5 ? stod(argv[5]) : 0});
+
+    World world;
+    makeScene(world, n, seed);
+    cout << format("{} particles, {} springs, {} frames, seed {}\n", world.particles.size(), world.springs.size(),
+                   frames, seed);
+    cout << format("{} precision, {} bytes per particle, {:.1f} MiB of particle data\n",
+                   sizeof(Real) == sizeof(float) ? "single" : "double", PARTICLE_BYTES,
+                   static_cast<double>(PARTICLE_BYTES * world.particles.size()) / (1 << 20));
+
+    PhaseTimes totals;
+    for (size_t frame{}; frame < frames; frame++) {
+        world.step();
+        if (recorder) recorder->record(world.particles, static_cast<double>(frame + 1) * world.physics->dt);
+        const auto& times = world.getPhaseTimes();
+        totals.integrate += times.integrate;
+        totals.broadPhase += times.broadPhase;
+        totals.narrowPhase += times.narrowPhase;
+        totals.constraints += times.constraints;
+        totals.sleep += times.sleep;
+        totals.cull += times.cull;
+    }
+
+    const auto report = [&](string_view phase, chrono::nanoseconds elapsed) {
+        const auto perStep = static_cast<double>(elapsed.count()) / static_cast<double>(frames);
+        const auto share = 100. * static_cast<double>(elapsed.count()) / static_cast<double>(totals.total().count());
+        cout << format("{:<14} {:>14.0f} ns/step {:>6.1f}%\n", phase, perStep, share);
+    };
+    report("integrate", totals.integrate);
+    report("broad-phase", totals.broadPhase);
+    report("narrow-phase", totals.narrowPhase);
+    report("constraints", totals.constraints);
+    report("sleep", totals.sleep);
+    report("cull", totals.cull);
+    report("total", totals.total());
+    cout << format("{} particles left, {} candidate pairs and {} collisions in the last step\n",
+                   world.particles.size(), world.physics->collisionStats.candidates,
+                   world.physics->collisionStats.hits);
+    if (recorder) {
+        cout << format("Recorded {} frames, {} bytes\n", recorder->getFrameCount(), recorder->getBytesWritten());
+    }
+}
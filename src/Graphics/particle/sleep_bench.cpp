@@ -0,0 +1,88 @@
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "World.hpp"
+#include "bench_scene.hpp"
+
+// Headless benchmark of sleeping
+// Drops a seeded cloud of particles into a box under gravity and lets it settle, once with sleeping off and once with
+// it on, then times the steps of the settled scene. Two scenes: a shallow layer of equal particles that comes to
+// rest, and a deep pile of mixed sizes that keeps churning, where sleeping can only pay for itself in part. With
+// sleeping on it also fires one particle into the settled scene and reports how many particles that woke and how long
+// the scene takes to fall back asleep.
+// Usage: sleep_bench [particles] [settle frames] [measured frames]
+
+using namespace std;
+
+struct Scene {
+    string_view name;
+    double widthScale;  // Of a box with the same density as a full window of WINDOW_PARTICLES
+    int minMass;
+    int maxMass;
+};
+
+void makeScene(World& world, const Scene& scene, size_t n) {
+    const auto box = windowBox(n, scene.widthScale);
+    scatterScene(world.particles, n, {0, 0}, box, {.maxSpeed = 20, .minMass = scene.minMass, .maxMass = scene.maxMass});
+    world.physics->setWinDim(0, static_cast<float>(box.x), 0, static_cast<float>(box.y));
+    world.physics->dt = 1. / 60;
+    world.physics->gravity = {0, 100};
+}
+
+void report(string_view name, const PhaseTimes& totals, size_t frames) {
+    const auto perStep = [&](chrono::nanoseconds elapsed) {
+        return static_cast<double>(elapsed.count()) / static_cast<double>(frames) / 1e6;
+    };
+    cout << format("{:<12} {:>8.3f} ms/step  integrate {:>7.3f}  broad-phase {:>7.3f}  narrow-phase {:>7.3f}  sleep "
+                   "{:>7.3f}\n",
+                   name, perStep(totals.total()), perStep(totals.integrate), perStep(totals.broadPhase),
+                   perStep(totals.narrowPhase), perStep(totals.sleep));
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? stoul(argv[1]) : 20'000;
+    const size_t settleFrames = argc > 2 ? stoul(argv[2]) : 1800;
+    const size_t frames = argc > 3 ? stoul(argv[3]) : 300;
+    cout << format("{} particles, {} frames to settle, {} measured\n", n, settleFrames, frames);
+
+    for (const auto& scene : {Scene{"shallow", 4, 2, 2}, Scene{"deep mixed", 1, 1, 3}}) {
+        cout << format("{} scene\n", scene.name);
+        for (const bool sleeping : {false, true}) {
+            World world;
+            makeScene(world, scene, n);
+            world.sleeping.enabled = sleeping;
+            for (size_t frame{}; frame < settleFrames; frame++) world.step();
+
+            PhaseTimes totals;
+            for (size_t frame{}; frame < frames; frame++) {
+                world.step();
+                const auto& times = world.getPhaseTimes();
+                totals.integrate += times.integrate;
+                totals.broadPhase += times.broadPhase;
+                totals.narrowPhase += times.narrowPhase;
+                totals.constraints += times.constraints;
+                totals.sleep += times.sleep;
+                totals.cull += times.cull;
+            }
+            report(sleeping ? "sleeping on" : "sleeping off", totals, frames);
+            cout << format("{:<12} {} of {} particles asleep, {} candidate pairs in the last step\n", "",
+                           world.particles.getSleepingCount(), world.particles.size(),
+                           world.physics->collisionStats.candidates);
+            if (!sleeping) continue;
+
+            // Fire the first particle straight down, waking it wakes its island
+            const auto before = world.particles.getSleepingCount();
+            world.wake(0);
+            world.particles.vy[0] = 500;
+            world.step();
+            cout << format("{:<12} firing a particle woke {} particles", "",
+                           before - min(before, world.particles.getSleepingCount()));
+            size_t steps{1};
+            for (; steps < settleFrames && world.particles.getSleepingCount() < before; steps++) world.step();
+            cout << format(", {} asleep again {} steps later\n", world.particles.getSleepingCount(), steps);
+        }
+    }
+}
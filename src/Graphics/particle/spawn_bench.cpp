@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "ParticleSystem.hpp"
+#include "Spawner.hpp"
+#include "bench_scene.hpp"
+#include "stopwatch.hpp"
+
+// Headless benchmark of particle spawning
+// Creates the same number of particles with every Spawner pattern and, for comparison, one at a time the way the
+// window used to: a generator seeded from std::random_device and a set of distributions per particle, with the
+// particle arrays left to grow on their own. Reports particles per second.
+// Usage: spawn_bench [particles]
+
+using namespace std;
+
+void perParticle(ParticleSystem& particles, size_t n) {
+    for (size_t i{}; i < n; i++) {
+        default_random_engine rng{random_device{}()};
+        uniform_real_distribution<double> rngX{0, WIDTH};
+        uniform_real_distribution<double> rngY{0, HEIGHT};
+        uniform_int_distribution<int> rngMass{2, 10};
+        uniform_real_distribution<double> rngVel{-20, 100};
+        uniform_int_distribution<int> rngColor{0, 255};
+        const auto x = rngX(rng);
+        const auto y = rngY(rng);
+        const auto vx = rngVel(rng);
+        const auto vy = rngVel(rng);
+        const auto mass = rngMass(rng);
+        particles.add(x, y, vx, vy, mass,
+                      {static_cast<uint8_t>(rngColor(rng)), static_cast<uint8_t>(rngColor(rng)),
+                       static_cast<uint8_t>(rngColor(rng)), 255});
+    }
+}
+
+void report(string_view name, size_t n, chrono::nanoseconds elapsed) {
+    const auto seconds = chrono::duration<double>(elapsed).count();
+    cout << format("{:<14} {:>9} particles {:>10.2f} ms {:>8.1f} M particles/s\n", name, n, seconds * 1e3,
+                   static_cast<double>(n) / seconds / 1e6);
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? stoul(argv[1]) : 1'000'000;
+    const SpawnAttributes attributes;
+
+    const auto run = [&](string_view name, const function<void(ParticleSystem&)>& spawn) {
+        ParticleSystem particles;
+        chrono::nanoseconds elapsed{};
+        {
+            Stopwatch stopwatch{elapsed};
+            spawn(particles);
+        }
+        report(name, particles.size(), elapsed);
+    };
+
+    run("per particle", [&](ParticleSystem& particles) { perParticle(particles, n); });
+    run("scatter", [&](ParticleSystem& particles) {
+        Spawner spawner{42};
+        spawner.scatter(particles, n, {0, 0}, {WIDTH, HEIGHT}, attributes);
+    });
+    run("burst", [&](ParticleSystem& particles) {
+        Spawner spawner{42};
+        spawner.burst(particles, n, {WIDTH / 2, HEIGHT / 2}, HEIGHT / 2, attributes);
+    });
+    run("lattice", [&](ParticleSystem& particles) {
+        Spawner spawner{42};
+        const auto side = static_cast<size_t>(std::sqrt(static_cast<double>(n)));
+        spawner.lattice(particles, side, n / side, {0, 0}, 2, {}, attributes);
+    });
+    run("stream", [&](ParticleSystem& particles) {
+        // One second of steps at 60 Hz
+        Spawner spawner{42};
+        StreamEmitter emitter{.position = {0, HEIGHT / 2}, .rate = static_cast<double>(n)};
+        for (int step{}; step < 60; step++) spawner.stream(particles, emitter, 1. / 60, attributes);
+    });
+    // Small calls, growing the arrays geometrically keeps them from reallocating every call
+    run("scatter by 10", [&](ParticleSystem& particles) {
+        Spawner spawner{42};
+        for (size_t spawned{}; spawned < n; spawned += 10)
+            spawner.scatter(particles, 10, {0, 0}, {WIDTH, HEIGHT}, attributes);
+    });
+}